@@ -0,0 +1,63 @@
+#include "ChannelStress.h"
+#include "Channel.h"
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+int channelStress(int producers, int items)
+{
+    //a small ring, so the producers keep spilling and the order across the ring and the spill lists is checked
+    gg::MChannel<std::unique_ptr<std::pair<int, int>>> channel(64);
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> threads;
+    for(int p = 0; p < producers; p++)
+    {
+        threads.push_back(std::thread([&channel, p, items]
+        {
+            for(int i = 0; i < items; i++)
+            {
+                channel.push(std::make_unique<std::pair<int, int>>(p, i));
+            }
+        }));
+    }
+
+    std::vector<int> next(producers, 0);
+    long received = 0, errors = 0;
+    std::unique_ptr<std::pair<int, int>> item;
+    while(received < static_cast<long>(producers) * items)
+    {
+        if(!channel.pop(item))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        //items of one producer arrive in the order they were sent
+        if(!item || item->first < 0 || item->first >= producers || item->second != next[item->first])
+        {
+            errors++;
+        }
+        else
+        {
+            next[item->first]++;
+        }
+        received++;
+    }
+    for(auto &&thread : threads)
+    {
+        thread.join();
+    }
+    if(channel.pop(item))
+    {
+        errors++;
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "channel: " << producers << " producers, " << received << " items in " << seconds << " s ("
+              << received / seconds / 1e6 << " M/s), " << errors << " errors\n";
+    return errors == 0 ? 0 : 1;
+}
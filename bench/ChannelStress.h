@@ -0,0 +1,11 @@
+/*
+ * stress test of gg::MChannel, run by ./build/bench channel [producers] [items per producer].
+ */
+
+#ifndef CHANNELSTRESS_H
+#define CHANNELSTRESS_H
+
+//returns 0 when every item arrived exactly once and in order per producer
+int channelStress(int producers, int items);
+
+#endif // CHANNELSTRESS_H
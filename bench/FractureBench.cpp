@@ -0,0 +1,600 @@
+/*
+ * measures the stages of the destruction pipeline in isolation on the bundled cube meshes.
+ * Every iteration cuts a fresh building with a Voronoi cell generated from a seeded random generator,
+ * so runs with the same seed are comparable between builds.
+ * The same cut is repeated with the floating-point booleans on triangle meshes and with corefinement
+ * of surface meshes, cuts they refuse are counted as fallbacks to the Nef polyhedra.
+ *
+ * The damage mode shoots one building again and again and reports how the time of a cut changes
+ * as the damage accumulates, for the Nef polyhedra and for the fast booleans. The grid mode does the same
+ * for the fast booleans alone on a finely subdivided cube, without loading any mesh.
+ * The shatter mode divides the part cut out by a shattering impact among the cells of the impact,
+ * once with one intersection of the part per cell and once as the split stage does it for a Nef
+ * polyhedron, with one overlay of the part with the walls of all cells.
+ *
+ * usage: bench [iterations] [seed]
+ *        bench damage [cuts] [seed]
+ *        bench grid [cuts] [subdivisions]
+ *        bench shatter [cells] [impacts]
+ *        bench split [copies]
+ *        bench weld [iterations]
+ *        bench channel [producers] [items per producer]
+ */
+
+#include "ChannelStress.h"
+#include "GridDamage.h"
+#include "CutterLibrary.h"
+#include "FastBoolean.h"
+#include "MeshManipulators.h"
+#include "Object.h"
+
+#include <irrlicht.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+namespace
+{
+    //time and memory samples of one stage on one mesh
+    struct StageSamples
+    {
+        std::vector<double> times;
+        long peakKiB = 0; //largest growth of the resident set above its size at the start of the stage
+    };
+
+    //forgets the peak resident set size so that the next stage is measured on its own
+    void resetPeakMemory()
+    {
+        std::ofstream clear_refs("/proc/self/clear_refs");
+        clear_refs << "5";
+    }
+
+    //field of /proc/self/status in KiB, VmHWM is the peak resident set size, VmRSS the current one
+    long memoryKiB(const std::string &field)
+    {
+        std::ifstream status("/proc/self/status");
+        std::string line;
+        while(std::getline(status, line))
+        {
+            if(line.compare(0, field.size(), field) == 0)
+            {
+                return std::stol(line.substr(field.size()));
+            }
+        }
+        return 0;
+    }
+
+    double percentile(std::vector<double> values, double p)
+    {
+        if(values.empty())
+        {
+            return 0;
+        }
+        std::sort(values.begin(), values.end());
+        size_t index = static_cast<size_t>(p * (values.size() - 1) + 0.5);
+        return values[index];
+    }
+
+    //runs the stage and stores its duration and how much the peak memory rose above the memory in use before it
+    template<class F>
+    void measure(StageSamples &samples, F &&stage)
+    {
+        resetPeakMemory();
+        long baseline = memoryKiB("VmRSS:");
+        gg::Timer t;
+        stage();
+        samples.times.push_back(t.elapsed());
+        samples.peakKiB = std::max(samples.peakKiB, memoryKiB("VmHWM:") - baseline);
+    }
+
+    //successive cuts of cube_2700.obj, every row averages a tenth of them
+    int damage(ISceneManager *scene, int cuts, unsigned seed)
+    {
+        IMesh *mesh_orig = scene->getMesh("media/cube_2700.obj");
+        if(!mesh_orig)
+        {
+            std::cerr << "media/cube_2700.obj could not be loaded\n";
+            return 1;
+        }
+        IMesh *mesh = scene->getMeshManipulator()->createMeshUniquePrimitives(mesh_orig);
+        scene->getMeshManipulator()->scale(mesh, vector3df(5, 5, 5));
+        box3df box = mesh->getBoundingBox();
+        gg::MeshManipulators::Nef_polyhedron nef(gg::MeshManipulators::makeNefPolyhedron(mesh));
+        gg::MTriangleMesh triangles(gg::MeshManipulators::convertToTriangleMesh(mesh));
+        mesh->drop();
+
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<float> along(0, 1);
+        //same cutters as MCollisionResolver::resolveCollision takes, but with a seeded generator
+        gg::MCutterLibrary library(seed);
+        int rows = std::max(cuts / 10, 1), fallbacks = 0;
+        std::vector<double> nefTimes, fastTimes;
+        std::cout << std::left << std::setw(8) << "cuts" << std::right << std::setw(14) << "nef facets"
+                  << std::setw(12) << "nef ms" << std::setw(14) << "triangles" << std::setw(12) << "fast ms" << "\n";
+        for(int i = 0; i < cuts; i++)
+        {
+            vector3df position(box.MinEdge.X + along(random) * (box.MaxEdge.X - box.MinEdge.X), box.MaxEdge.Y,
+                               box.MinEdge.Z + along(random) * (box.MaxEdge.Z - box.MinEdge.Z));
+            std::vector<gg::MeshManipulators::Cutter> cutters{library.cutter(2.f, position, false)};
+
+            gg::Timer t;
+            std::tie(nef, std::ignore) = gg::MeshManipulators::subtractMesh(nef, cutters);
+            nefTimes.push_back(t.elapsed());
+
+            t.reset();
+            try
+            {
+                std::tie(triangles, std::ignore) = gg::MeshManipulators::subtractMesh(triangles, cutters);
+            }
+            catch(gg::MFastBoolean::Degenerate &)
+            {
+                //like the game, the cut is repeated exactly and the object goes on as a triangle mesh
+                gg::MeshManipulators::Nef_polyhedron exact(gg::MeshManipulators::makeNefPolyhedron(triangles));
+                std::tie(exact, std::ignore) = gg::MeshManipulators::subtractMesh(exact, cutters);
+                triangles = gg::MeshManipulators::convertToTriangleMesh(exact);
+                fallbacks++;
+            }
+            fastTimes.push_back(t.elapsed());
+
+            if((i + 1) % rows == 0)
+            {
+                auto mean = [rows](const std::vector<double> &times) {
+                    double sum = 0;
+                    for(size_t j = times.size() - rows; j < times.size(); j++)
+                    {
+                        sum += times[j];
+                    }
+                    return sum / rows * 1000;
+                };
+                std::cout << std::left << std::setw(8) << i + 1 << std::right << std::setw(14) << nef.number_of_facets()
+                          << std::fixed << std::setprecision(3) << std::setw(12) << mean(nefTimes)
+                          << std::setw(14) << triangles.triangleCount() << std::setw(12) << mean(fastTimes) << "\n";
+            }
+        }
+        std::cout << "fast cuts repeated on Nef polyhedra: " << fallbacks << " of " << cuts << "\n";
+        return 0;
+    }
+
+    //the part a shattering impact cuts out of cube_2700.obj divided among the cells, per cell and in one overlay
+    int shatter(ISceneManager *scene, unsigned cells, int impacts)
+    {
+        IMesh *mesh_orig = scene->getMesh("media/cube_2700.obj");
+        if(!mesh_orig)
+        {
+            std::cerr << "media/cube_2700.obj could not be loaded\n";
+            return 1;
+        }
+        IMesh *mesh = scene->getMeshManipulator()->createMeshUniquePrimitives(mesh_orig);
+        scene->getMeshManipulator()->scale(mesh, vector3df(5, 5, 5));
+        box3df box = mesh->getBoundingBox();
+        gg::MeshManipulators::Nef_polyhedron nef(gg::MeshManipulators::makeNefPolyhedron(mesh));
+        mesh->drop();
+
+        std::mt19937 random(42);
+        std::uniform_real_distribution<float> along(0, 1);
+        gg::MCutterLibrary library(42, cells);
+        std::vector<double> before, after;
+        for(int i = 0; i < impacts; i++)
+        {
+            vector3df position(box.MinEdge.X + along(random) * (box.MaxEdge.X - box.MinEdge.X), box.MaxEdge.Y,
+                               box.MinEdge.Z + along(random) * (box.MaxEdge.Z - box.MinEdge.Z));
+            gg::MeshManipulators::Cutter impact(library.shatter(2.f, position));
+            gg::MeshManipulators::Nef_polyhedron region;
+            std::tie(std::ignore, region) = gg::MeshManipulators::subtractMesh(nef, impact);
+            std::shared_ptr<const std::vector<gg::MTriangleMesh>> complex(std::get<3>(impact));
+
+            //one intersection of the part per cell
+            gg::Timer t;
+            for(auto &&cell : *complex)
+            {
+                gg::MeshManipulators::Cutter cellCutter(impact);
+                std::get<0>(cellCutter) = std::shared_ptr<const gg::MTriangleMesh>(complex, &cell);
+                std::get<3>(cellCutter) = nullptr;
+                gg::MeshManipulators::intersectMesh(region, cellCutter);
+            }
+            before.push_back(t.elapsed());
+
+            //the walls of the cells taken out of the part in one overlay
+            t.reset();
+            gg::MeshManipulators::partitionMesh(region, impact);
+            after.push_back(t.elapsed());
+        }
+        std::sort(before.begin(), before.end());
+        std::sort(after.begin(), after.end());
+        std::cout << "median ms to divide the part cut out among " << cells << " cells: per cell "
+                  << std::fixed << std::setprecision(3) << before[before.size() / 2] * 1000 << ", walls "
+                  << after[after.size() / 2] * 1000 << "\n";
+        return 0;
+    }
+
+    //splitPolyhedron on 1, 2, 4, ... disjoint copies of cube_10092.obj, the time per facet should stay flat
+    int split(ISceneManager *scene, int copies)
+    {
+        IMesh *mesh_orig = scene->getMesh("media/cube_10092.obj");
+        if(!mesh_orig)
+        {
+            std::cerr << "media/cube_10092.obj could not be loaded\n";
+            return 1;
+        }
+        IMesh *mesh = scene->getMeshManipulator()->createMeshUniquePrimitives(mesh_orig);
+        scene->getMeshManipulator()->scale(mesh, vector3df(5, 5, 5));
+        box3df box = mesh->getBoundingBox();
+        gg::MTriangleMesh cube(gg::MeshManipulators::convertToTriangleMesh(mesh));
+        mesh->drop();
+
+        double width = (box.MaxEdge.X - box.MinEdge.X) * 1.5;
+        std::cout << std::left << std::setw(8) << "copies" << std::right << std::setw(12) << "facets"
+                  << std::setw(8) << "parts" << std::setw(12) << "split ms" << std::setw(14) << "us per facet" << "\n";
+        for(int n = 1; n <= copies; n *= 2)
+        {
+            gg::MTriangleMesh all;
+            for(int c = 0; c < n; c++)
+            {
+                uint32_t offset = static_cast<uint32_t>(all.vertexCount());
+                for(size_t i = 0; i < cube.vertices.size(); i++)
+                {
+                    all.vertices.push_back(cube.vertices[i] + (i % 3 == 0 ? c * width : 0));
+                }
+                for(auto &&index : cube.indices)
+                {
+                    all.indices.push_back(index + offset);
+                }
+            }
+            gg::MeshManipulators::Nef_polyhedron nef(gg::MeshManipulators::makeNefPolyhedron(all));
+
+            gg::Timer t;
+            std::vector<gg::MeshManipulators::Nef_polyhedron> parts(gg::MeshManipulators::splitPolyhedron(nef));
+            double ms = t.elapsed() * 1000;
+            std::cout << std::left << std::setw(8) << n << std::right << std::setw(12) << nef.number_of_facets()
+                      << std::setw(8) << parts.size() << std::fixed << std::setprecision(3) << std::setw(12) << ms
+                      << std::setw(14) << ms * 1000 / nef.number_of_facets() << "\n";
+        }
+        return 0;
+    }
+
+    //welding as it was done before the hash, a map ordered by the float positions
+    gg::MTriangleMesh mapWeld(IMesh *obj)
+    {
+        gg::MTriangleMesh mesh;
+        std::map<vector3df, uint32_t> vertex_map;
+        for(u32 j = 0; j < obj->getMeshBufferCount(); j++)
+        {
+            IMeshBuffer *meshBuffer = obj->getMeshBuffer(j);
+            video::S3DVertex *IVertices = (video::S3DVertex *) meshBuffer->getVertices();
+            gg::MeshManipulators::visitIndices(meshBuffer, [&](auto IIndices) {
+                for(u32 i = 0; i < meshBuffer->getIndexCount(); i++)
+                {
+                    vector3df vertex = IVertices[IIndices[i]].Pos;
+                    auto found = vertex_map.find(vertex);
+                    if(found == vertex_map.end())
+                    {
+                        found = vertex_map.insert(
+                                std::make_pair(vertex, static_cast<uint32_t>(mesh.vertexCount()))).first;
+                        mesh.vertices.push_back(vertex.X);
+                        mesh.vertices.push_back(vertex.Y);
+                        mesh.vertices.push_back(vertex.Z);
+                    }
+                    mesh.indices.push_back(found->second);
+                }
+            });
+        }
+        return mesh;
+    }
+
+    //welding of the unwelded cube meshes with the ordered map and with the open-addressing hash
+    int weld(ISceneManager *scene, int iterations)
+    {
+        const std::vector<std::string> meshes = {"cube_108.obj", "cube_588.obj", "cube_2700.obj", "cube_10092.obj"};
+        std::cout << std::left << std::setw(16) << "mesh" << std::right << std::setw(10) << "corners"
+                  << std::setw(10) << "vertices" << std::setw(12) << "map ms" << std::setw(12) << "hash ms"
+                  << std::setw(12) << "grid ms" << "\n";
+        for(auto &&file : meshes)
+        {
+            IMesh *mesh_orig = scene->getMesh(("media/" + file).c_str());
+            if(!mesh_orig)
+            {
+                std::cerr << "media/" << file << " could not be loaded\n";
+                continue;
+            }
+            //every triangle with its own corners, so that all of them have to be welded
+            IMesh *mesh = scene->getMeshManipulator()->createMeshUniquePrimitives(mesh_orig);
+            scene->getMeshManipulator()->scale(mesh, vector3df(5, 5, 5));
+
+            StageSamples ordered, hash, grid;
+            gg::MTriangleMesh mapped, hashed;
+            for(int i = 0; i < iterations; i++)
+            {
+                measure(ordered, [&] { mapped = mapWeld(mesh); });
+                measure(hash, [&] { hashed = gg::MeshManipulators::convertToTriangleMesh(mesh); });
+                measure(grid, [&] { gg::MeshManipulators::convertToTriangleMesh(mesh, vector3df(0, 0, 0), 1e-4); });
+            }
+            if(mapped.vertexCount() != hashed.vertexCount())
+            {
+                std::cerr << file << ": the map welded " << mapped.vertexCount() << " vertices, the hash "
+                          << hashed.vertexCount() << "\n";
+            }
+            std::cout << std::left << std::setw(16) << file << std::right << std::setw(10) << hashed.indices.size()
+                      << std::setw(10) << hashed.vertexCount() << std::fixed << std::setprecision(3)
+                      << std::setw(12) << percentile(ordered.times, 0.5) * 1000
+                      << std::setw(12) << percentile(hash.times, 0.5) * 1000
+                      << std::setw(12) << percentile(grid.times, 0.5) * 1000 << "\n";
+            mesh->drop();
+        }
+        return 0;
+    }
+
+    u32 triangleCount(IMesh *mesh)
+    {
+        u32 count = 0;
+        for(u32 i = 0; i < mesh->getMeshBufferCount(); i++)
+        {
+            count += mesh->getMeshBuffer(i)->getIndexCount() / 3;
+        }
+        return count;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if(argc > 1 && std::string(argv[1]) == "channel")
+    {
+        return channelStress(argc > 2 ? std::stoi(argv[2]) : 8, argc > 3 ? std::stoi(argv[3]) : 1000000);
+    }
+
+    if(argc > 1 && std::string(argv[1]) == "grid")
+    {
+        return gridDamage(argc > 2 ? std::stoi(argv[2]) : 500, argc > 3 ? std::stoi(argv[3]) : 60, 7);
+    }
+
+    IrrlichtDevice *device = createDevice(video::EDT_NULL);
+    device->getLogger()->setLogLevel(ELL_NONE);
+    ISceneManager *scene = device->getSceneManager();
+
+    if(argc > 1 && std::string(argv[1]) == "damage")
+    {
+        int result = damage(scene, argc > 2 ? std::stoi(argv[2]) : 50, argc > 3 ? std::stoul(argv[3]) : 42);
+        device->drop();
+        return result;
+    }
+
+    if(argc > 1 && std::string(argv[1]) == "shatter")
+    {
+        int result = shatter(scene, argc > 2 ? std::stoul(argv[2]) : 8, argc > 3 ? std::stoi(argv[3]) : 10);
+        device->drop();
+        return result;
+    }
+
+    if(argc > 1 && std::string(argv[1]) == "split")
+    {
+        int result = split(scene, argc > 2 ? std::stoi(argv[2]) : 8);
+        device->drop();
+        return result;
+    }
+
+    if(argc > 1 && std::string(argv[1]) == "weld")
+    {
+        int result = weld(scene, argc > 2 ? std::stoi(argv[2]) : 50);
+        device->drop();
+        return result;
+    }
+
+    int iterations = argc > 1 ? std::stoi(argv[1]) : 20;
+    unsigned seed = argc > 2 ? std::stoul(argv[2]) : 42;
+
+    const std::vector<std::string> meshes = {"cube_108.obj", "cube_588.obj", "cube_2700.obj", "cube_10092.obj"};
+    const std::vector<std::string> stages = {"makeNefPolyhedron", "subtractMesh", "splitPolyhedron",
+                                             "convertPolyToMesh", "btHACDCompoundShape", "convertToTriangleMesh",
+                                             "fastSubtractMesh", "components", "fastConvertPolyToMesh",
+                                             "makeSurfaceMesh", "corefineSubtractMesh", "splitConnectedComponents",
+                                             "surfaceConvertPolyToMesh"};
+
+    std::cout << std::left << std::setw(16) << "mesh" << std::setw(11) << "triangles" << std::setw(21) << "stage"
+              << std::right << std::setw(12) << "median ms" << std::setw(12) << "p95 ms" << std::setw(12) << "max ms"
+              << std::setw(12) << "peak +MiB" << "\n";
+
+    for(auto &&file : meshes)
+    {
+        IMesh *mesh_orig = scene->getMesh(("media/" + file).c_str());
+        if(!mesh_orig)
+        {
+            std::cerr << "media/" << file << " could not be loaded\n";
+            continue;
+        }
+        IMesh *mesh = scene->getMeshManipulator()->createMeshUniquePrimitives(mesh_orig);
+        scene->getMeshManipulator()->scale(mesh, vector3df(5, 5, 5));
+        box3df box = mesh->getBoundingBox();
+
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<float> along(0, 1);
+        gg::MCutterLibrary library(seed);
+        std::map<std::string, StageSamples> samples;
+        int fallbacks = 0, corefineFallbacks = 0;
+
+        for(int i = 0; i < iterations; i++)
+        {
+            gg::MeshManipulators::Nef_polyhedron nef;
+            measure(samples["makeNefPolyhedron"], [&] { nef = gg::MeshManipulators::makeNefPolyhedron(mesh); });
+
+            //hit a random point on the top face, like a shot coming from above
+            vector3df position(box.MinEdge.X + along(random) * (box.MaxEdge.X - box.MinEdge.X), box.MaxEdge.Y,
+                               box.MinEdge.Z + along(random) * (box.MaxEdge.Z - box.MinEdge.Z));
+            gg::MeshManipulators::Cutter cutter(library.cutter(2.f, position, false));
+
+            gg::MeshManipulators::Nef_polyhedron difference, debree;
+            measure(samples["subtractMesh"], [&] {
+                std::tie(difference, debree) = gg::MeshManipulators::subtractMesh(nef, cutter);
+            });
+
+            gg::MTriangleMesh triangleMesh;
+            measure(samples["convertToTriangleMesh"], [&] {
+                triangleMesh = gg::MeshManipulators::convertToTriangleMesh(mesh);
+            });
+
+            gg::MTriangleMesh fastDifference;
+            std::vector<gg::MTriangleMesh> fastDebris;
+            bool degenerate = false;
+            measure(samples["fastSubtractMesh"], [&] {
+                try
+                {
+                    std::tie(fastDifference, fastDebris) = gg::MeshManipulators::subtractMesh(
+                            triangleMesh, std::vector<gg::MeshManipulators::Cutter>{cutter});
+                }
+                catch(gg::MFastBoolean::Degenerate &)
+                {
+                    degenerate = true;
+                }
+            });
+
+            gg::MeshManipulators::Surface_mesh surface;
+            measure(samples["makeSurfaceMesh"], [&] { surface = gg::MeshManipulators::makeSurfaceMesh(mesh); });
+
+            gg::MeshManipulators::Surface_mesh surfaceDifference, surfaceDebree;
+            bool refused = false;
+            measure(samples["corefineSubtractMesh"], [&] {
+                try
+                {
+                    std::tie(surfaceDifference, surfaceDebree) = gg::MeshManipulators::subtractMesh(
+                            surface, std::vector<gg::MeshManipulators::Cutter>{cutter});
+                }
+                catch(std::exception &)
+                {
+                    refused = true;
+                }
+            });
+
+            if(refused)
+            {
+                corefineFallbacks++;
+            }
+            else
+            {
+                std::vector<gg::MeshManipulators::Surface_mesh> surfacePieces;
+                measure(samples["splitConnectedComponents"], [&] {
+                    surfacePieces = gg::MeshManipulators::splitPolyhedron(std::move(surfaceDifference));
+                    std::vector<gg::MeshManipulators::Surface_mesh> debreePieces(
+                            gg::MeshManipulators::splitPolyhedron(std::move(surfaceDebree)));
+                    surfacePieces.insert(surfacePieces.end(), debreePieces.begin(), debreePieces.end());
+                });
+
+                measure(samples["surfaceConvertPolyToMesh"], [&] {
+                    for(auto &&piece : surfacePieces)
+                    {
+                        IMesh *pieceMesh;
+                        vector3df center;
+                        std::tie(pieceMesh, center) = gg::MeshManipulators::convertPolyToMesh(piece);
+                        if(pieceMesh)
+                        {
+                            pieceMesh->drop();
+                        }
+                    }
+                });
+            }
+
+            if(degenerate)
+            {
+                fallbacks++;
+            }
+            else
+            {
+                std::vector<gg::MTriangleMesh> fastPieces;
+                measure(samples["components"], [&] {
+                    fastPieces = fastDifference.components();
+                    for(auto &&part : fastDebris)
+                    {
+                        std::vector<gg::MTriangleMesh> debreePieces(part.components());
+                        fastPieces.insert(fastPieces.end(), debreePieces.begin(), debreePieces.end());
+                    }
+                });
+
+                measure(samples["fastConvertPolyToMesh"], [&] {
+                    for(auto &&piece : fastPieces)
+                    {
+                        IMesh *pieceMesh;
+                        vector3df center;
+                        std::tie(pieceMesh, center) = gg::MeshManipulators::convertPolyToMesh(piece);
+                        if(pieceMesh)
+                        {
+                            pieceMesh->drop();
+                        }
+                    }
+                });
+            }
+
+            std::vector<gg::MeshManipulators::Nef_polyhedron> pieces;
+            measure(samples["splitPolyhedron"], [&] {
+                pieces = gg::MeshManipulators::splitPolyhedron(std::move(difference));
+                std::vector<gg::MeshManipulators::Nef_polyhedron> debreePieces(
+                        gg::MeshManipulators::splitPolyhedron(std::move(debree)));
+                pieces.insert(pieces.end(), debreePieces.begin(), debreePieces.end());
+            });
+
+            std::vector<IMesh *> pieceMeshes;
+            measure(samples["convertPolyToMesh"], [&] {
+                for(auto &&piece : pieces)
+                {
+                    IMesh *pieceMesh;
+                    vector3df center;
+                    std::tie(pieceMesh, center) = gg::MeshManipulators::convertPolyToMesh(piece);
+                    if(pieceMesh)
+                    {
+                        pieceMeshes.push_back(pieceMesh);
+                    }
+                }
+            });
+
+            //every piece of the cut is decomposed, like in the game
+            std::vector<btCollisionShape *> pieceTriangles;
+            for(auto &&pieceMesh : pieceMeshes)
+            {
+                pieceTriangles.push_back(gg::MeshManipulators::convertMesh(pieceMesh));
+            }
+            measure(samples["btHACDCompoundShape"], [&] {
+                for(auto &&triangles : pieceTriangles)
+                {
+                    btCollisionShape *shape = new btHACDCompoundShape(triangles);
+                    delete shape;
+                }
+            });
+            for(auto &&triangles : pieceTriangles)
+            {
+                delete static_cast<btBvhTriangleMeshShape *>(triangles)->getMeshInterface();
+                delete triangles;
+            }
+            for(auto &&pieceMesh : pieceMeshes)
+            {
+                pieceMesh->drop();
+            }
+        }
+
+        for(auto &&stage : stages)
+        {
+            const StageSamples &s = samples[stage];
+            std::cout << std::left << std::setw(16) << file << std::setw(11) << triangleCount(mesh)
+                      << std::setw(21) << stage << std::right << std::fixed << std::setprecision(3)
+                      << std::setw(12) << percentile(s.times, 0.5) * 1000
+                      << std::setw(12) << percentile(s.times, 0.95) * 1000
+                      << std::setw(12) << percentile(s.times, 1.0) * 1000
+                      << std::setw(12) << s.peakKiB / 1024.0 << "\n";
+        }
+        std::cout << std::left << std::setw(16) << file << std::setw(11) << triangleCount(mesh)
+                  << std::setw(21) << "fast fallbacks" << std::right << std::setw(12) << fallbacks
+                  << " of " << iterations << "\n";
+        std::cout << std::left << std::setw(16) << file << std::setw(11) << triangleCount(mesh)
+                  << std::setw(21) << "corefine fallbacks" << std::right << std::setw(12) << corefineFallbacks
+                  << " of " << iterations << "\n";
+        mesh->drop();
+    }
+
+    device->drop();
+    return 0;
+}
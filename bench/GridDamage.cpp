@@ -0,0 +1,141 @@
+#include "GridDamage.h"
+#include "FastBoolean.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+
+namespace
+{
+    //cube of the given size centred at the origin, every face divided into subdivisions^2 squares
+    gg::MTriangleMesh gridCube(int subdivisions, double size)
+    {
+        gg::MTriangleMesh mesh;
+        std::map<std::array<long, 3>, uint32_t> ids;
+        auto id = [&](const std::array<long, 3> &corner)
+        {
+            auto found = ids.find(corner);
+            if(found != ids.end())
+            {
+                return found->second;
+            }
+            uint32_t index = static_cast<uint32_t>(mesh.vertexCount());
+            for(long c : corner)
+            {
+                mesh.vertices.push_back(c * size / subdivisions - size / 2);
+            }
+            ids[corner] = index;
+            return index;
+        };
+        for(int axis = 0; axis < 3; axis++)
+        {
+            for(int side = 0; side < 2; side++)
+            {
+                for(int i = 0; i < subdivisions; i++)
+                {
+                    for(int j = 0; j < subdivisions; j++)
+                    {
+                        auto corner = [&](int a, int b)
+                        {
+                            std::array<long, 3> c;
+                            c[axis] = side * subdivisions;
+                            c[(axis + 1) % 3] = a;
+                            c[(axis + 2) % 3] = b;
+                            return id(c);
+                        };
+                        uint32_t p00 = corner(i, j), p10 = corner(i + 1, j), p11 = corner(i + 1, j + 1), p01 = corner(i, j + 1);
+                        //outward normals: the far side keeps the order of the axes, the near side reverses it
+                        if(side)
+                        {
+                            mesh.indices.insert(mesh.indices.end(), {p00, p10, p11, p00, p11, p01});
+                        }
+                        else
+                        {
+                            mesh.indices.insert(mesh.indices.end(), {p00, p11, p10, p00, p01, p11});
+                        }
+                    }
+                }
+            }
+        }
+        return mesh;
+    }
+
+    //icosahedron under a random affine map close to a scaling, placed at the given point
+    gg::MTriangleMesh cutter(std::mt19937 &random, double x, double y, double z, double scale)
+    {
+        const double t = (1 + std::sqrt(5.0)) / 2;
+        const double vertices[12][3] = {{-1, t, 0}, {1, t, 0}, {-1, -t, 0}, {1, -t, 0}, {0, -1, t}, {0, 1, t},
+                                        {0, -1, -t}, {0, 1, -t}, {t, 0, -1}, {t, 0, 1}, {-t, 0, -1}, {-t, 0, 1}};
+        const uint32_t faces[20][3] = {{0, 11, 5}, {0, 5, 1}, {0, 1, 7}, {0, 7, 10}, {0, 10, 11}, {1, 5, 9}, {5, 11, 4},
+                                       {11, 10, 2}, {10, 7, 6}, {7, 1, 8}, {3, 9, 4}, {3, 4, 2}, {3, 2, 6}, {3, 6, 8},
+                                       {3, 8, 9}, {4, 9, 5}, {2, 4, 11}, {6, 2, 10}, {8, 6, 7}, {9, 8, 1}};
+        std::uniform_real_distribution<double> skew(-1, 1);
+        double map[3][3];
+        for(int i = 0; i < 3; i++)
+        {
+            for(int j = 0; j < 3; j++)
+            {
+                map[i][j] = skew(random) + (i == j ? 2 : 0);
+            }
+        }
+        const double origin[3] = {x, y, z};
+        gg::MTriangleMesh mesh;
+        for(auto &&v : vertices)
+        {
+            for(int i = 0; i < 3; i++)
+            {
+                //rounded to floats like the cutters of the game
+                mesh.vertices.push_back(float((map[i][0] * v[0] + map[i][1] * v[1] + map[i][2] * v[2]) * scale + origin[i]));
+            }
+        }
+        for(auto &&face : faces)
+        {
+            mesh.indices.insert(mesh.indices.end(), {face[0], face[1], face[2]});
+        }
+        return mesh;
+    }
+}
+
+int gridDamage(int cuts, int subdivisions, unsigned seed)
+{
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<double> across(-5, 5);
+    gg::MTriangleMesh solid(gridCube(subdivisions, 10));
+    //the index is kept with the solid from cut to cut, as the geometry of an object keeps it in the game
+    gg::MTriangleIndex index(solid);
+    int rows = std::max(cuts / 10, 1), refused = 0, inRow = 0;
+    double rowMs = 0;
+    std::cout << std::left << std::setw(8) << "cuts" << std::right << std::setw(14) << "triangles" << std::setw(12)
+              << "fast ms" << "\n" << std::fixed << std::setprecision(3);
+    for(int i = 0; i < cuts; i++)
+    {
+        //the cutters bite into the top face, so the damage piles up where the next cuts land
+        gg::MTriangleMesh shape(cutter(random, across(random), 5, across(random), 30.0 / subdivisions));
+        auto start = std::chrono::steady_clock::now();
+        try
+        {
+            gg::MFastBoolean::subtract(solid, index, shape);
+        }
+        catch(gg::MFastBoolean::Degenerate &)
+        {
+            //the game would repeat the cut on Nef polyhedra, here the solid stays as it was
+            refused++;
+        }
+        rowMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if(++inRow == rows || i + 1 == cuts)
+        {
+            std::cout << std::left << std::setw(8) << i + 1 << std::right << std::setw(14) << solid.triangleCount()
+                      << std::setw(12) << rowMs / inRow << "\n";
+            rowMs = 0;
+            inRow = 0;
+        }
+    }
+    bool closed = solid.isClosed();
+    std::cout << refused << " cuts refused, solid " << (closed ? "closed" : "open") << "\n";
+    return closed ? 0 : 1;
+}
@@ -0,0 +1,14 @@
+/*
+ * growth of the cost of a fast cut with the accumulated damage, run by ./build/bench grid [cuts] [subdivisions].
+ * Needs neither Irrlicht nor CGAL: the solid is a finely subdivided cube built in place and the cutters are
+ * random affine images of an icosahedron, cut in place by gg::MFastBoolean alone. The cutters shrink with the squares,
+ * so a cut meets about as many triangles at every subdivision.
+ */
+
+#ifndef GRIDDAMAGE_H
+#define GRIDDAMAGE_H
+
+//returns 0 when the solid is still closed after the last cut
+int gridDamage(int cuts, int subdivisions, unsigned seed);
+
+#endif // GRIDDAMAGE_H
@@ -61,6 +61,7 @@ struct Params {
 	double scaleFactor;				// (1000.0) Normalization factor used to ensure that the other parameters (e.g. concavity) are expressed w.r.t. a fixed size. DO NOT USE IT TO SCALE YOUR MESH!
 	double smallClusterThreshold;	// (0.25) Threshold on the clusters area (expressed as a percentage of the entire mesh area) under which the cluster is considered small and it is forced to be merged with other clusters at the price of a high concavity. 
 	size_t heapManagerChunkSize;	// please ignore this. (65536*1000) Memory consumption of the J.Ratcliff micro allocator (default should be 32768 (32k), but in HACD test program 65536*1000 is used (64M)).
+	HACD::HeapManager* heapManager;	// (NULL) When set, this heap manager (owned by the caller) is reused instead of creating and releasing one per decomposition. It must not be shared by threads decomposing at the same time.
 
 
 	// W.I.P.: ADDITIONAL PARAMS ADDED BY ME (TO BE TESTED)
@@ -277,6 +278,7 @@ struct Params {
 				connectionDistance(					30.0),				
 				smallClusterThreshold(				0.25),
 				heapManagerChunkSize(				65536*1000),//32768),//65536*1000),
+				heapManager(						NULL),
 				keepSubmeshesSeparated(				false),
 				decomposeACleanCopyOfTheMesh(		true),
 				decomposeADecimatedCopyOfTheMesh(	false),
@@ -493,14 +495,16 @@ struct HACDCreatorWrapper{
 	HACD::HACD* hacd;
 	typedef HACD::HACD& HACDREF;
 	size_t heapManagerChunkSize;
+	bool ownsHeapManager;
 	
 	public:
-	HACDCreatorWrapper(size_t _heapManagerChunkSize=32768) : heapManagerChunkSize(_heapManagerChunkSize),heapManager(NULL),hacd(NULL) {
+	HACDCreatorWrapper(size_t _heapManagerChunkSize=32768,HACD::HeapManager* externalHeapManager=NULL) : heapManager(externalHeapManager),hacd(NULL),heapManagerChunkSize(_heapManagerChunkSize),ownsHeapManager(externalHeapManager==NULL) {
 		reset();
 	}
 	void reset()	{
 		//printf("START HACDCreatorWrapper::reset()\n");
 		if (hacd) {HACD::DestroyHACD(hacd);hacd=NULL;}
+		if (ownsHeapManager)	{
 		//#define REUSE_EXISTING_HEAPMANAGER
 		#ifdef REUSE_EXISTING_HEAPMANAGER
 		if (!heapManager)
@@ -509,6 +513,7 @@ struct HACDCreatorWrapper{
 		if (heapManager) {HACD::releaseHeapManager(heapManager);heapManager=NULL;}		
 		#endif //REUSE_EXISTING_HEAPMANAGER	
 		heapManager = HACD::createHeapManager(heapManagerChunkSize);
+		}
 		if (heapManager) hacd = HACD::CreateHACD(heapManager);
 		//printf("END HACDCreatorWrapper::reset()\n");
 
@@ -518,13 +523,13 @@ struct HACDCreatorWrapper{
 	~HACDCreatorWrapper()	{
 		//printf("START ~HACDCreatorWrapper()\n");
 		if (hacd)  {HACD::DestroyHACD(hacd);hacd=NULL;}
-		if (heapManager) {HACD::releaseHeapManager(heapManager);heapManager=NULL;}
+		if (heapManager && ownsHeapManager) {HACD::releaseHeapManager(heapManager);heapManager=NULL;}
 		//printf("END ~HACDCreatorWrapper()\n");
 	}
 };
 
 void performHACDMainWork(const Params& params,std::vector< HACD::Vec3<HACD::Real> >& points,std::vector< HACD::Vec3<long> >& triangles,const int subPart=-1)	{		
-		HACDCreatorWrapper hacdWrapper(params.heapManagerChunkSize);
+		HACDCreatorWrapper hacdWrapper(params.heapManagerChunkSize,params.heapManager);
 		if (!hacdWrapper.isOK()) {printf("CRITICAL ERROR: creation of HACD instance failed.\n");return;}
 		HACD::HACD& myHACD = hacdWrapper;
 		
@@ -0,0 +1,207 @@
+/*
+ * lock-free channel from many producer threads to one consumer thread.
+ * The channel is a ring of slots, each with a sequence number that tells whose turn it is:
+ * producers claim a slot by advancing the shared tail with a compare and swap and publish
+ * the value by bumping the slot's sequence, the consumer only reads its own head.
+ * A producer finding the ring full does not wait for the consumer, it appends the value to a
+ * linked spill list of its own and keeps using that list until the consumer has emptied it.
+ * The consumer takes from the spill lists only when every claimed slot of the ring is taken,
+ * so the values of one producer arrive in the order they were sent.
+ * Neither side ever takes a lock. Values are moved in and out, so move-only records can be sent.
+ */
+
+#ifndef CHANNEL_H
+#define CHANNEL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+namespace gg
+{
+
+    template<class T>
+    class MChannel
+    {
+    public:
+        //capacity is rounded up to a power of two
+        explicit MChannel(size_t capacity = 1024)
+        {
+            size_t size = 2;
+            while(size < capacity)
+            {
+                size <<= 1;
+            }
+            m_mask = size - 1;
+            m_slots.reset(new Slot[size]);
+            for(size_t i = 0; i < size; i++)
+            {
+                m_slots[i].sequence.store(i, std::memory_order_relaxed);
+            }
+            m_tail.store(0, std::memory_order_relaxed);
+            m_spills.store(nullptr, std::memory_order_relaxed);
+        }
+
+        MChannel(const MChannel &) = delete;
+
+        MChannel &operator=(const MChannel &) = delete;
+
+        ~MChannel()
+        {
+            Spill *spill = m_spills.load(std::memory_order_acquire);
+            while(spill)
+            {
+                Spill *next = spill->next;
+                while(spill->head)
+                {
+                    Node *node = spill->head;
+                    spill->head = node->next.load(std::memory_order_relaxed);
+                    delete node;
+                }
+                delete spill;
+                spill = next;
+            }
+        }
+
+        //any thread, false when the channel is full
+        bool tryPush(T &&value)
+        {
+            size_t position = m_tail.load(std::memory_order_relaxed);
+            Slot *slot;
+            while(true)
+            {
+                slot = &m_slots[position & m_mask];
+                size_t sequence = slot->sequence.load(std::memory_order_acquire);
+                intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+                if(difference == 0)
+                {
+                    if(m_tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    {
+                        break;
+                    }
+                }
+                else if(difference < 0)
+                {
+                    //the consumer has not yet emptied the slot from the previous lap
+                    return false;
+                }
+                else
+                {
+                    position = m_tail.load(std::memory_order_relaxed);
+                }
+            }
+            slot->value = std::move(value);
+            slot->sequence.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        //any thread, never waits, values that do not fit in the ring go to the spill list of the thread
+        void push(T &&value)
+        {
+            Spill &spill = localSpill();
+            //once a value is spilled, the following ones must not overtake it through the ring
+            if(spill.count.load(std::memory_order_acquire) == 0 && tryPush(std::move(value)))
+            {
+                return;
+            }
+            Node *node = new Node;
+            node->value = std::move(value);
+            spill.count.fetch_add(1, std::memory_order_relaxed);
+            spill.tail->next.store(node, std::memory_order_release);
+            spill.tail = node;
+        }
+
+        //consumer thread only, false when there is nothing to take
+        bool pop(T &value)
+        {
+            Slot &slot = m_slots[m_head & m_mask];
+            if(slot.sequence.load(std::memory_order_acquire) == m_head + 1)
+            {
+                value = std::move(slot.value);
+                slot.sequence.store(m_head + m_mask + 1, std::memory_order_release);
+                m_head++;
+                return true;
+            }
+            for(Spill *spill = m_spills.load(std::memory_order_acquire); spill; spill = spill->next)
+            {
+                Node *next = spill->head->next.load(std::memory_order_acquire);
+                if(next)
+                {
+                    //a slot still in the ring may hold an older value of the same producer, the tail is read
+                    //after the node, so every slot that producer claimed before spilling is counted in it
+                    if(m_tail.load(std::memory_order_acquire) != m_head)
+                    {
+                        return false;
+                    }
+                    value = std::move(next->value);
+                    delete spill->head;
+                    spill->head = next;
+                    spill->count.fetch_sub(1, std::memory_order_release);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+    private:
+        struct Slot
+        {
+            std::atomic<size_t> sequence;
+            T value;
+        };
+
+        struct Node
+        {
+            T value;
+            std::atomic<Node *> next{nullptr};
+        };
+
+        //single producer, single consumer list behind a dummy node
+        struct Spill
+        {
+            Node *head; //consumer only, the dummy
+            Node *tail; //producer only
+            std::atomic<size_t> count{0}; //values not taken yet
+            Spill *next = nullptr; //next list of the channel, fixed once registered
+        };
+
+        //every channel gets its own id, so a list is never looked up for a destroyed channel at the same address
+        static uint64_t nextId()
+        {
+            static std::atomic<uint64_t> id(0);
+            return ++id;
+        }
+
+        //spill list of the calling thread, registered with the channel on first use
+        Spill &localSpill()
+        {
+            thread_local std::unordered_map<uint64_t, Spill *> spills;
+            Spill *&spill = spills[m_id];
+            if(!spill)
+            {
+                spill = new Spill;
+                spill->head = spill->tail = new Node;
+                spill->next = m_spills.load(std::memory_order_relaxed);
+                while(!m_spills.compare_exchange_weak(spill->next, spill, std::memory_order_release,
+                                                      std::memory_order_relaxed))
+                {
+                }
+            }
+            return *spill;
+        }
+
+        const uint64_t m_id = nextId();
+        std::atomic<Spill *> m_spills; //owned by the channel
+        std::unique_ptr<Slot[]> m_slots;
+        size_t m_mask;
+        //producers and the consumer write different cache lines
+        std::atomic<size_t> m_tail;
+        char m_padding[64];
+        size_t m_head = 0;
+    };
+
+}
+
+#endif // CHANNEL_H
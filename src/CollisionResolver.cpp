@@ -1,5 +1,9 @@
 #include "CollisionResolver.h"
 #include <cmath>
+#include <algorithm>
+#include <limits>
+#include <chrono>
+#include <CGAL/FPU.h>
 
 using namespace irr;
 using namespace core;
@@ -24,28 +28,103 @@ std::ostream& operator<<(std::ostream& os, const btVector3& v)
 }
 #endif
 
+//0 uses one worker per hardware thread
+static unsigned poolSize(unsigned workers)
+{
+    return std::max(workers ? workers : std::thread::hardware_concurrency(), 1u);
+}
+
+static unsigned cutterSeed(const gg::MSettings &settings)
+{
+    if(settings.seed)
+    {
+        return settings.seed;
+    }
+    if(settings.headless)
+    {
+        return 1;
+    }
+    return static_cast<unsigned>(std::chrono::steady_clock::now().time_since_epoch().count());
+}
+
 gg::MCollisionResolver::MCollisionResolver(IrrlichtDevice* irrDev, btDiscreteDynamicsWorld* btDDW,
-                                           MObjectCreator* creator, std::vector<std::unique_ptr<MObject>>* objs)
+                                           MObjectCreator* creator, std::vector<std::unique_ptr<MObject>>* objs,
+                                           const MSettings& settings)
         : m_irrDevice(irrDev),
           m_btWorld(btDDW),
           m_objectCreator(creator),
-          m_objects(objs)
+          m_objects(objs),
+          m_applyBudget(settings.applyBudget / 1000),
+          m_softLimit(settings.softLimit),
+          m_hardLimit(settings.hardLimit),
+          m_boolean(settings.boolean),
+          m_cutters(cutterSeed(settings), settings.shatterCells),
+          m_telemetry("data/telemetry", settings.telemetryInterval),
+          m_splitStage("split", poolSize(settings.subtractionWorkers),
+                       [this](SplitTask &task, CgalThread &) { splitPieces(task); }),
+          m_meshStage("meshConversion", poolSize(settings.subtractionWorkers),
+                      [this](MeshTask &task, CgalThread &) { convertPiece(task); }),
+          m_decompositionStage("meshDecomposer", poolSize(settings.decompositionWorkers),
+                               [this](DecompositionTask &task, HacdThread &hacd) { decomposePiece(task, hacd); }),
+          m_prefetchStage("prefetch", 1, [this](MObject *&obj, CgalThread &) { prefetchGeometry(obj); })
 {
     m_done.store(false);
-    m_subtractor = std::move(std::thread([this] { meshSubtractor(); }));
-    m_decomposer = std::move(std::thread([this] { meshDecomposer(); }));
-    m_file_subtraction.open("data/subtraction.times");
-    m_file_decomposition.open("data/decomposition.times");
-    m_file_total.open("data/total.times");
+    for(unsigned i = 0; i < poolSize(settings.subtractionWorkers); i++)
+    {
+        m_subtractors.push_back(std::thread([this] { meshSubtractor(); }));
+    }
 }
 
 gg::MCollisionResolver::~MCollisionResolver()
 {
     m_done.store(true);
-    m_subtractionCondVar.notify_one();
-    m_decompositionCondVar.notify_one();
-    m_subtractor.join();
-    m_decomposer.join();
+    m_subtractionCondVar.notify_all();
+    for(auto &&subtractor : m_subtractors)
+    {
+        subtractor.join();
+    }
+    //every stage pushes into the next one, so they stop from the front
+    m_splitStage.stop();
+    m_meshStage.stop();
+    m_decompositionStage.stop();
+    m_prefetchStage.stop();
+    //shapes of finished decompositions are the only results not owned by a piece
+    DecompositionResult result;
+    while(m_decompositionResults.pop(result))
+    {
+        m_pendingDecompositions.push_back(std::move(result));
+    }
+    for(auto &&pending : m_pendingDecompositions)
+    {
+        delete std::get<1>(pending);
+    }
+    m_telemetry.snapshot();
+}
+
+gg::MCollisionResolver::Piece::~Piece()
+{
+    if(mesh)
+    {
+        mesh->drop();
+    }
+    delete shape;
+}
+
+gg::MCollisionResolver::CgalThread::CgalThread()
+{
+    CGAL::FPU_set_cw(CGAL_FE_TONEAREST);
+}
+
+gg::MCollisionResolver::HacdThread::HacdThread()
+{
+    params.heapManager = HACD::createHeapManager(params.heapManagerChunkSize);
+    fast.resetForSpeed();
+    fast.heapManager = params.heapManager;
+}
+
+gg::MCollisionResolver::HacdThread::~HacdThread()
+{
+    HACD::releaseHeapManager(params.heapManager);
 }
 
 void gg::MCollisionResolver::resolveCollision(MObject* obj, btVector3 point,
@@ -69,35 +148,39 @@ void gg::MCollisionResolver::resolveCollision(MObject* obj, btVector3 point,
         }
         if(obj->isMesh() && ((other->getType() != MObject::Type::GROUND && impulse > 100)|| impulse > 200 || other->getType() == MObject::Type::SHOT))
         {
-            using namespace voro;
-            float cube_size = impulse/10.f;
-            vector3df cube_min(-cube_size, -cube_size, -cube_size);
-            vector3df cube_max(cube_size, cube_size, cube_size);
-
-            container con(cube_min.X, cube_max.X,
-                          cube_min.Y, cube_max.Y,
-                          cube_min.Z, cube_max.Z,
-                          8,8,8,
-                          false,false,false,
-                          8);
-
-            con.put(0,0,0,0);
-            for(auto&& i : {1,2})
+            vector3df impact_point(point.x(), point.y(), point.z());
+            if(detachChunks(obj, impact_point, impulse/10.f))
             {
-                con.put(i,std::fmod(rand(),cube_size*2) + cube_min.X, std::fmod(rand(),cube_size*2) + cube_min.Y, std::fmod(rand(),cube_size*2) + cube_min.Z);
+                return;
             }
+            size_t outstanding = outstandingWork();
+            vector3df relative_position(impact_point - obj->getNode()->getPosition());
+            //under load the cutter is the plain cube, it has the fewest faces to intersect
+            bool plain = m_softLimit != 0 && outstanding >= m_softLimit;
+            MeshManipulators::Cutter cutter(plain ? m_cutters.cutter(impulse/10.f, relative_position, true)
+                                                  : m_cutters.shatter(impulse/10.f, relative_position));
 
-            c_loop_all loop(con);
-            loop.start();
-            voronoicell c;
-            con.compute_cell(c,loop);
-            IMesh* debree_mesh = gg::MeshManipulators::convertMesh(c);
-
+            f32 priority = impactPriority(impact_point, impulse);
             std::lock_guard<std::mutex> lock (m_subtractionTasksMutex);
-            vector3df relative_position(vector3df(point.x(),point.y(),point.z()) - obj->getNode()->getPosition());
-            obj->reference_count++;
             obj->m_timer.reset();
-            m_subtractionTasks.push_back(std::make_tuple(obj, debree_mesh, relative_position));
+            auto pending = pendingSubtractionTask(obj);
+            if(pending != m_subtractionTasks.end())
+            {
+                //the object is cut once for the whole burst of contacts
+                MTraceSpan span("impact", std::get<3>(*pending), MTrace::Flow::STEP);
+                mergeCutters(std::get<1>(*pending), {std::move(cutter)});
+                std::get<4>(*pending) = std::max(std::get<4>(*pending), priority);
+                return;
+            }
+            if(m_hardLimit != 0 && outstanding >= m_hardLimit && !admit(priority))
+            {
+                return;
+            }
+            uint64_t flow = MTrace::newFlow();
+            MTraceSpan span("impact", flow, MTrace::Flow::START);
+            obj->reference_count++;
+            m_subtractionTasks.push_back(std::make_tuple(obj, std::vector<MeshManipulators::Cutter>{std::move(cutter)}, Timer(), flow, priority));
+            m_telemetry.setGauge(MTelemetry::Gauge::SUBTRACTION_QUEUE, m_subtractionTasks.size());
             m_subtractionCondVar.notify_one();
         }
     }
@@ -105,193 +188,942 @@ void gg::MCollisionResolver::resolveCollision(MObject* obj, btVector3 point,
 
 }
 
+void gg::MCollisionResolver::prefetch(btVector3 position, btVector3 impulse)
+{
+    if(m_boolean == MSettings::Boolean::FAST || impulse.fuzzyZero())
+    {
+        //the fast booleans cut the triangle mesh every object is created with
+        return;
+    }
+    btVector3 to(position + impulse.normalized() * 1000);
+    btCollisionWorld::AllHitsRayResultCallback hits(position, to);
+    m_btWorld->rayTest(position, to, hits);
+    MObject *nearest = nullptr;
+    btScalar nearestFraction = 1;
+    for(int i = 0; i < hits.m_collisionObjects.size(); i++)
+    {
+        MObject *obj = static_cast<MObject *>(hits.m_collisionObjects[i]->getUserPointer());
+        if(obj && obj->isMesh() && obj->getType() != MObject::Type::SHIP && hits.m_hitFractions[i] <= nearestFraction)
+        {
+            nearest = obj;
+            nearestFraction = hits.m_hitFractions[i];
+        }
+    }
+    if(!nearest || nearest->deleted)
+    {
+        return;
+    }
+    if(nearest->version == 0 && nearest->prefracture.valid()
+       && nearest->prefracture.wait_for(std::chrono::seconds(0)) == std::future_status::ready && nearest->prefracture.get())
+    {
+        //the object breaks into its chunks without any booleans
+        return;
+    }
+    nearest->reference_count++;
+    m_prefetchStage.push(std::move(nearest));
+}
+
+void gg::MCollisionResolver::prefetchGeometry(MObject *obj)
+{
+    MTraceSpan span("prefetch");
+    int version = obj->version;
+    MGeometry prepared;
+    {
+        std::lock_guard<std::mutex> lock(obj->m_mutex);
+        MGeometry &geometry = obj->getGeometry();
+        bool ready = m_boolean == MSettings::Boolean::NEF ? geometry.hasNef() : geometry.hasSurface();
+        if(!obj->deleted && !ready && !geometry.empty())
+        {
+            prepared = MGeometry(MTriangleMesh(geometry.mesh()));
+        }
+    }
+    //the object stays unlocked while the structure is built, a cut in the meantime builds its own
+    if(!prepared.empty())
+    {
+        try
+        {
+            if(m_boolean == MSettings::Boolean::NEF)
+            {
+                prepared.nef();
+            }
+            else
+            {
+                prepared.surface();
+            }
+            std::lock_guard<std::mutex> lock(obj->m_mutex);
+            MGeometry &geometry = obj->getGeometry();
+            if(obj->version == version && !geometry.empty() && !geometry.hasNef() && !geometry.hasSurface())
+            {
+                geometry = std::move(prepared);
+            }
+        }
+        catch(...)
+        {
+            //the cut converts the mesh itself and falls back to the Nef polyhedra
+        }
+    }
+    obj->reference_count--;
+}
+
+bool gg::MCollisionResolver::detachChunks(MObject *obj, const vector3df &impact, f32 radius)
+{
+    if(!obj->prefracture.valid() || obj->prefracture.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+    {
+        return false;
+    }
+    const MPrefracture *prefracture = obj->prefracture.get().get();
+    if(!prefracture || prefracture->chunks().empty())
+    {
+        return false;
+    }
+    if(obj->chunkShapes.empty())
+    {
+        //the pattern only matches the object as it was loaded
+        std::lock_guard<std::mutex> lock(m_subtractionTasksMutex);
+        if(obj->version > 0 || m_busyObjects.count(obj) != 0 || pendingSubtractionTask(obj) != m_subtractionTasks.end())
+        {
+            return false;
+        }
+        attachChunks(obj, *prefracture);
+    }
+
+    Timer t;
+    MTraceSpan span("detachChunks");
+    const std::vector<MPrefracture::Chunk> &chunks = prefracture->chunks();
+    quaternion quat(obj->getNode()->getRelativeTransformation());
+    quaternion polyQuat(obj->getPolyhedronTransform());
+    quaternion quatInverse(quat), polyQuatInverse(polyQuat);
+    quatInverse.makeInverse();
+    polyQuatInverse.makeInverse();
+    vector3df local(polyQuatInverse * (quatInverse * (impact - obj->getNode()->getPosition())) + obj->translation);
+
+    //chunks within the radius of the impact, at least the nearest one
+    std::vector<size_t> selected;
+    size_t nearest = chunks.size();
+    f32 nearestDistance = std::numeric_limits<f32>::max();
+    for(size_t i = 0; i < chunks.size(); i++)
+    {
+        if(!obj->chunkShapes[i])
+        {
+            continue;
+        }
+        f32 distance = chunks[i].center.getDistanceFromSQ(local);
+        if(distance <= radius * radius)
+        {
+            selected.push_back(i);
+        }
+        if(distance < nearestDistance)
+        {
+            nearest = i;
+            nearestDistance = distance;
+        }
+    }
+    if(nearest == chunks.size())
+    {
+        return true;
+    }
+    if(selected.empty())
+    {
+        selected.push_back(nearest);
+    }
+
+    btCompoundShape *shape = static_cast<btCompoundShape *>(obj->getRigid()->getCollisionShape());
+    SMesh *mesh = static_cast<SMesh *>(static_cast<IMeshSceneNode *>(obj->getNode())->getMesh());
+    //buffers of detached chunks are removed, so the later ones move down, hence the reverse order
+    for(auto i = selected.rbegin(); i != selected.rend(); i++)
+    {
+        const MPrefracture::Chunk &chunk = chunks[*i];
+        u32 buffer = static_cast<u32>(std::count_if(obj->chunkShapes.begin(), obj->chunkShapes.begin() + *i,
+                                                    [](btCollisionShape *hull) { return hull != nullptr; }));
+        mesh->getMeshBuffer(buffer)->drop();
+        mesh->MeshBuffers.erase(buffer);
+        shape->removeChildShape(obj->chunkShapes[*i]);
+        delete obj->chunkShapes[*i];
+        obj->chunkShapes[*i] = nullptr;
+
+        vector3df newPosition(quat * (polyQuat * (chunk.center - obj->translation)) + obj->getNode()->getPosition());
+        btVector3 position(newPosition.X, newPosition.Y, newPosition.Z);
+        //the node of the debris shares the render mesh of the pattern
+        std::unique_ptr<MObject> object(m_objectCreator->createMeshRigidBodyWithTmpShape(
+                chunk.render, position, 10, obj->getType(), MGeometry(chunk.mesh)));
+        btConvexHullShape *hull = new btConvexHullShape(&chunk.hull[0].getX(), static_cast<int>(chunk.hull.size()),
+                                                        sizeof(btVector3));
+        hull->setMargin(0.01f);
+        btVector3 inertia;
+        hull->calculateLocalInertia(10, inertia);
+        object->setCollisionShape(hull);
+        object->getRigid()->setMassProps(10, inertia);
+        object->translation = chunk.center;
+        object->m_timer = obj->m_timer;
+        btTransform tr(obj->getRigid()->getOrientation());
+        tr.setOrigin(position);
+        object->getRigid()->setWorldTransform(tr);
+        m_btWorld->addRigidBody(object->getRigid());
+        m_objects->push_back(std::move(object));
+    }
+    mesh->recalculateBoundingBox();
+    shape->recalculateLocalAabb();
+    obj->getRigid()->activate();
+
+    if(mesh->getMeshBufferCount() == 0)
+    {
+        //every chunk has fallen off
+        m_btWorld->removeCollisionObject(obj->getRigid());
+        obj->deleted = true;
+    }
+    m_telemetry.record(MTelemetry::Stage::APPLY, t.elapsed());
+    return true;
+}
+
+void gg::MCollisionResolver::attachChunks(MObject *obj, const MPrefracture &prefracture)
+{
+    MTraceSpan span("attachChunks");
+    quaternion polyQuat(obj->getPolyhedronTransform());
+    btQuaternion rotation(polyQuat.X, polyQuat.Y, polyQuat.Z, polyQuat.W);
+    SMesh *mesh = new SMesh();
+    MChunkShape *shape = new MChunkShape();
+    for(auto &&chunk : prefracture.chunks())
+    {
+        //every object has buffers of its own, the pattern is shared
+        vector3df offset(polyQuat * (chunk.center - obj->translation));
+        IMeshBuffer *source = chunk.render->getMeshBuffer(0);
+        CDynamicMeshBuffer *buffer = MeshManipulators::createMeshBuffer(source->getVertexCount(),
+                                                                        source->getIndexCount());
+        const S3DVertex *vertices = static_cast<const S3DVertex *>(source->getVertices());
+        for(u32 i = 0; i < source->getVertexCount(); i++)
+        {
+            buffer->getVertexBuffer()[i] = vertices[i];
+            buffer->getVertexBuffer()[i].Pos = polyQuat * vertices[i].Pos + offset;
+        }
+        MeshManipulators::visitIndices(source, [&](auto indices) {
+            for(u32 i = 0; i < source->getIndexCount(); i++)
+            {
+                buffer->getIndexBuffer().setValue(i, indices[i]);
+            }
+        });
+        buffer->recalculateBoundingBox();
+        mesh->addMeshBuffer(buffer);
+        buffer->drop();
+
+        btConvexHullShape *hull = new btConvexHullShape(&chunk.hull[0].getX(), static_cast<int>(chunk.hull.size()),
+                                                        sizeof(btVector3));
+        hull->setMargin(0.01f);
+        shape->addChildShape(btTransform(rotation, btVector3(offset.X, offset.Y, offset.Z)), hull);
+        obj->chunkShapes.push_back(hull);
+    }
+    mesh->recalculateBoundingBox();
+    IMeshSceneNode *node = static_cast<IMeshSceneNode *>(obj->getNode());
+    node->setMesh(mesh);
+    node->setMaterialType(EMT_SOLID);
+    node->setMaterialFlag(EMF_LIGHTING, 1);
+    node->setMaterialFlag(EMF_NORMALIZE_NORMALS, true);
+    mesh->drop();
+    obj->setCollisionShape(shape);
+    //the object is not cut any more, the chunks carry their own geometry
+    std::lock_guard<std::mutex> objLock(obj->m_mutex);
+    obj->getGeometry() = MGeometry();
+}
+
 void gg::MCollisionResolver::meshSubtractor()
 {
     MObject* obj;
-    IMesh* mesh;
-    vector3df position;
+    std::vector<MeshManipulators::Cutter> cutters;
+    Timer queued;
+    uint64_t flow;
+    MTrace::nameThread("meshSubtractor");
+    CgalThread cgal;
     while(!m_done)
     {
         std::unique_lock<std::mutex> taskLock(m_subtractionTasksMutex);
-        m_subtractionCondVar.wait(taskLock, [this]() { return !m_subtractionTasks.empty() || m_done;});
-        if(m_subtractionTasks.size() > 0)
+        m_subtractionCondVar.wait(taskLock, [this]() { return nextSubtractionTask() != m_subtractionTasks.end() || m_done;});
+        auto task = nextSubtractionTask();
+        if(task != m_subtractionTasks.end())
         {
-            std::tie(obj, mesh, position) = m_subtractionTasks.front();
-            m_subtractionTasks.pop_front();
+            std::tie(obj, cutters, queued, flow, std::ignore) = std::move(*task);
+            m_subtractionTasks.erase(task);
+            m_telemetry.setGauge(MTelemetry::Gauge::SUBTRACTION_QUEUE, m_subtractionTasks.size());
+            m_busyObjects.insert(obj);
             taskLock.unlock();
+            MTraceSpan span("subtraction", flow, MTrace::Flow::STEP);
+            m_telemetry.record(MTelemetry::Stage::ENQUEUE_WAIT, queued.elapsed());
 
             if(obj->deleted)
             {
-                return;
-            }      
-            int old_version = obj->version.load();
+                cutters.clear();
+                releaseObject(obj);
+                obj->reference_count--;
+                continue;
+            }
+            bool released = false;
             try
             {
                 quaternion quat(obj->getNode()->getRelativeTransformation());
                 quat.makeInverse();
-                position = quat * position;
-                quat = obj->getPolyhedronTransform();
-                position = quat.makeInverse() * position + obj->translation;
+                quaternion polyQuat(obj->getPolyhedronTransform());
+                polyQuat.makeInverse();
+                for(auto &&cutter : cutters)
+                {
+                    vector3df &position = std::get<1>(cutter);
+                    position = polyQuat * (quat * position) + obj->translation;
+                }
                 Timer t;
-                MeshManipulators::Nef_polyhedron newPoly, debree;
+                MGeometry rest;
+                std::vector<MGeometry> debris;
                 {
                     std::lock_guard<std::mutex> objlock(obj->m_mutex);
-                    std::tie(newPoly, debree) = MeshManipulators::subtractMesh(obj->getPolyhedron(), mesh, position);
+                    std::tie(rest, debris) = subtract(obj->getGeometry(), cutters);
                 }
+                m_telemetry.record(MTelemetry::Stage::SUBTRACTION, t.elapsed());
 
-                std::vector<MeshManipulators::Nef_polyhedron> newNefPolyhedrons(std::move(MeshManipulators::splitPolyhedron(std::move(newPoly))));
-                std::vector<MeshManipulators::Nef_polyhedron> debreeVector(std::move(MeshManipulators::splitPolyhedron(std::move(debree))));
-                newNefPolyhedrons.insert(newNefPolyhedrons.end(), debreeVector.begin(), debreeVector.end());
-                for(size_t i = 0; i < newNefPolyhedrons.size(); i++)
+                //a shattering impact cuts out the cube around it, the split task of each part that was
+                //cut out divides it among the cells of the cube
+                MeshManipulators::Cutter shatter;
+                if(std::get<3>(cutters.front()))
                 {
-                    IMesh* new_mesh;
-                    vector3df center;
-                    std::tie(new_mesh, center) = MeshManipulators::convertPolyToMesh(newNefPolyhedrons[i]);
-                    std::lock_guard<std::mutex> resLock(m_subtractionResultsMutex);
-                    if(i == 0)
-                    {
-                        obj->reference_count++;
-                        m_subtractionResults.push(std::make_tuple(obj,
-                                                                  obj->getRigid()->getCenterOfMassPosition(),
-                                                                  obj->getRigid()->getOrientation(),
-                                                                  std::move(newNefPolyhedrons[0]),
-                                                                  new_mesh,
-                                                                  old_version));
-                    }
-                    else
-                    {
-                        vector3df newPosition;
-                        newPosition = quaternion(obj->getNode()->getRelativeTransformation()) * center;
-                        newPosition += obj->getNode()->getPosition();
-                        MObject* newObj = new MObject(NULL, NULL, obj->getType(), false);
-                        newObj->translation = center;
-                        newObj->reference_count++;
-                        m_subtractionResults.push(
-                                std::make_tuple(newObj,
-                                                btVector3(newPosition.X, newPosition.Y, newPosition.Z),
-                                                obj->getRigid()->getOrientation(),
-                                                std::move(newNefPolyhedrons[i]),
-                                                new_mesh,
-                                                old_version));
-                    }
+                    shatter = cutters.front();
+                }
+
+                //the object stays busy until the main thread has applied the cut, so no other cut of it
+                //can start from the geometry this one replaces
+                std::shared_ptr<Cut> cut(std::make_shared<Cut>());
+                cut->target = obj;
+                cut->pending = 1 + static_cast<int>(debris.size());
+                cut->flow = flow;
+                released = true;
+                obj->reference_count++;
+                m_splitStage.push(std::make_tuple(cut, std::move(rest), true, MeshManipulators::Cutter()));
+                for(auto &&part : debris)
+                {
+                    m_splitStage.push(std::make_tuple(cut, std::move(part), false, shatter));
                 }
-                m_file_subtraction << t.elapsed() << "\n";
             }
             catch(...)
             {
                 std::cout << "FAILED\n";
             }
+            if(!released)
+            {
+                cutters.clear();
+                releaseObject(obj);
+            }
             obj->reference_count--;
         }
     }
 }
 
-void gg::MCollisionResolver::meshDecomposer()
+std::tuple<gg::MGeometry, std::vector<gg::MGeometry>>
+    gg::MCollisionResolver::subtract(MGeometry &geometry, const std::vector<MeshManipulators::Cutter> &cutters)
 {
-    MObject* obj;
-    IMesh* mesh;
+    std::vector<MGeometry> debris;
+    std::vector<MeshManipulators::Cutter> left(cutters);
+    if(m_boolean == MSettings::Boolean::FAST)
+    {
+        //the cutters are cut out of the geometry in place one after another, so the object holds what remains
+        //of it before the cut is applied; no other cut of the object can start in the meantime
+        try
+        {
+            while(!left.empty())
+            {
+                if(std::get<0>(left.front()))
+                {
+                    MTriangleMesh inside(geometry.subtractFast(MeshManipulators::placeCutter(left.front())));
+                    if(!inside.empty())
+                    {
+                        debris.emplace_back(std::move(inside));
+                    }
+                }
+                left.erase(left.begin());
+            }
+            return std::make_tuple(geometry, std::move(debris));
+        }
+        catch(MFastBoolean::Degenerate &)
+        {
+            //the Nef booleans decide every configuration, at their usual cost, for the cutters that are left
+            m_telemetry.addGauge(MTelemetry::Gauge::NEF_FALLBACKS, 1);
+        }
+    }
+    else if(m_boolean == MSettings::Boolean::COREFINEMENT)
+    {
+        try
+        {
+            MeshManipulators::Surface_mesh rest, cutOff;
+            std::tie(rest, cutOff) = MeshManipulators::subtractMesh(geometry.surface(), cutters);
+            debris.emplace_back(std::move(cutOff));
+            return std::make_tuple(MGeometry(std::move(rest)), std::move(debris));
+        }
+        catch(std::exception &)
+        {
+            //corefinement refuses self-intersecting or non-manifold surfaces
+            m_telemetry.addGauge(MTelemetry::Gauge::NEF_FALLBACKS, 1);
+        }
+    }
+    MeshManipulators::Nef_polyhedron rest, cutOff;
+    std::tie(rest, cutOff) = MeshManipulators::subtractMesh(geometry.nef(), left);
+    debris.emplace_back(std::move(cutOff));
+    return std::make_tuple(MGeometry(std::move(rest)), std::move(debris));
+}
 
-    while(!m_done)
+std::vector<gg::MGeometry> gg::MCollisionResolver::partition(MGeometry &geometry, const MeshManipulators::Cutter &shatter)
+{
+    //the cells share their walls, cutting them out one after another would leave every next cell
+    //coplanar with the hole of the previous one, so the walls are taken out of the geometry at once
+    std::vector<MGeometry> fragments;
+    for(auto &&fragment : MeshManipulators::partitionMesh(geometry.nef(), shatter))
+    {
+        fragments.emplace_back(std::move(fragment));
+    }
+    return fragments;
+}
+
+gg::MGeometry gg::MCollisionResolver::intersect(MGeometry &geometry, const MeshManipulators::Cutter &cutter)
+{
+    if(m_boolean == MSettings::Boolean::FAST)
     {
-        std::unique_lock<std::mutex> taskLock(m_decompositionTasksMutex);
-        m_decompositionCondVar.wait(taskLock, [this]() { return !m_decompositionTasks.empty() || m_done;});
-        if(m_decompositionTasks.size() > 0)
+        try
         {
-            std::tie(obj, mesh) = m_decompositionTasks.front();
-            m_decompositionTasks.pop();
-            taskLock.unlock();
-            gg::Timer t;
-            btCollisionShape *shape = new btHACDCompoundShape(MeshManipulators::convertMesh(mesh));
-            shape->setMargin(0.01f);
-            std::lock_guard<std::mutex> resLock(m_decompositionResultsMutex);
-            m_decompositionResults.push(std::make_tuple(obj, shape));
-            m_file_decomposition << t.elapsed() << "\n";
+            return MGeometry(geometry.intersectFast(MeshManipulators::placeCutter(cutter)));
+        }
+        catch(MFastBoolean::Degenerate &)
+        {
+            m_telemetry.addGauge(MTelemetry::Gauge::NEF_FALLBACKS, 1);
+        }
+    }
+    else if(m_boolean == MSettings::Boolean::COREFINEMENT)
+    {
+        try
+        {
+            return MGeometry(MeshManipulators::intersectMesh(geometry.surface(), cutter));
+        }
+        catch(std::exception &)
+        {
+            m_telemetry.addGauge(MTelemetry::Gauge::NEF_FALLBACKS, 1);
+        }
+    }
+    //the geometry keeps its Nef polyhedron, later cells that fall back reuse it
+    return MGeometry(MeshManipulators::intersectMesh(geometry.nef(), cutter));
+}
+
+std::deque<gg::MCollisionResolver::SubtractionTask>::iterator gg::MCollisionResolver::pendingSubtractionTask(MObject *obj)
+{
+    return std::find_if(m_subtractionTasks.begin(), m_subtractionTasks.end(),
+                        [obj](auto &&task) { return std::get<0>(task) == obj; });
+}
+
+void gg::MCollisionResolver::mergeCutters(std::vector<MeshManipulators::Cutter> &pending,
+                                          std::vector<MeshManipulators::Cutter> cutters)
+{
+    pending.insert(pending.end(), cutters.begin(), cutters.end());
+    //the partitions of overlapping impacts would overlap too
+    for(auto &&cutter : pending)
+    {
+        std::get<3>(cutter) = nullptr;
+    }
+}
+
+std::deque<gg::MCollisionResolver::SubtractionTask>::iterator gg::MCollisionResolver::nextSubtractionTask()
+{
+    //the queue holds at most one task per object, a scan is cheaper than keeping a heap ordered while the tasks age
+    auto best = m_subtractionTasks.end();
+    f32 bestPriority = 0;
+    for(auto task = m_subtractionTasks.begin(); task != m_subtractionTasks.end(); task++)
+    {
+        //tasks of one object run one after another, so each of them cuts the result of the previous one
+        if(m_busyObjects.count(std::get<0>(*task)) != 0)
+        {
+            continue;
+        }
+        f32 priority = agedPriority(*task);
+        if(best == m_subtractionTasks.end() || priority > bestPriority)
+        {
+            best = task;
+            bestPriority = priority;
         }
     }
+    return best;
 }
 
-void gg::MCollisionResolver::subtractionApplier()
+f32 gg::MCollisionResolver::agedPriority(const SubtractionTask &task)
 {
+    //waiting raises the priority, so even a weak hit far behind the camera is cut eventually
+    return std::get<4>(task) * (1 + std::get<2>(task).elapsed() / PRIORITY_AGING);
+}
 
-    MObject* obj = NULL;
-    IMesh* new_mesh = NULL;
-    btVector3 position;
-    int old_version;
-    btQuaternion rotation;
-    MeshManipulators::Nef_polyhedron newPoly;
+bool gg::MCollisionResolver::admit(f32 priority)
+{
+    //the queue is full, the weakest impact is dropped, either a queued one or the new one
+    auto weakest = m_subtractionTasks.end();
+    f32 weakestPriority = priority;
+    for(auto task = m_subtractionTasks.begin(); task != m_subtractionTasks.end(); task++)
     {
-        std::lock_guard<std::mutex> resLock(m_subtractionResultsMutex);
-        while(m_subtractionResults.size() > 0)
+        f32 taskPriority = agedPriority(*task);
+        if(taskPriority < weakestPriority)
         {
-            std::tie(obj, position, rotation, newPoly, new_mesh, old_version) = m_subtractionResults.front();
-            m_subtractionResults.pop();
-            if(obj && new_mesh)
+            weakest = task;
+            weakestPriority = taskPriority;
+        }
+    }
+    m_telemetry.addGauge(MTelemetry::Gauge::DROPPED_IMPACTS, 1);
+    if(weakest == m_subtractionTasks.end())
+    {
+        return false;
+    }
+    std::get<0>(*weakest)->reference_count--;
+    m_subtractionTasks.erase(weakest);
+    return true;
+}
+
+f32 gg::MCollisionResolver::impactPriority(const vector3df &point, btScalar impulse)
+{
+    f32 priority = impulse;
+    ICameraSceneNode* camera = m_irrDevice->getSceneManager()->getActiveCamera();
+    if(camera)
+    {
+        vector3df eye(camera->getAbsolutePosition());
+        priority /= 1 + eye.getDistanceFrom(point) / PRIORITY_DISTANCE;
+        const SViewFrustum* frustum = camera->getViewFrustum();
+        bool visible = true;
+        for(s32 i = 0; i < SViewFrustum::VF_PLANE_COUNT; i++)
+        {
+            if(frustum->planes[i].classifyPointRelation(point) == ISREL3D_FRONT)
             {
-                if(obj->version > old_version)
-                {
-                    return;
-                }
-                {
-                    std::lock_guard<std::mutex> objLock(obj->m_mutex);
-                    obj->setPolyhedron(std::move(newPoly));
-                }
-                if(obj->getRigid())
-                {
-                    IMeshSceneNode* Node = static_cast<IMeshSceneNode*>(obj->getNode());
-                    Node->setMesh(new_mesh);
-                    Node->setMaterialType(EMT_SOLID);
-                    Node->setMaterialFlag(EMF_LIGHTING, 1);
-                    Node->setMaterialFlag(EMF_NORMALIZE_NORMALS, true);
-                    Node->setAutomaticCulling(irr::scene::EAC_OFF);
-                    obj->version++;
-                }
-                else
-                {
-                    std::unique_ptr<MObject> object(m_objectCreator->createMeshRigidBodyWithTmpShape(new_mesh, position, 10, obj->getType(), std::move(newPoly)));
-                    object->reference_count.store(obj->reference_count);
-                    object->translation = obj->translation;
-                    delete obj;
-                    obj = object.get();
-                    btTransform tr(rotation);
-                    tr.setOrigin(position);
-                    obj->getRigid()->setWorldTransform(tr);
-                    m_objects->push_back(std::move(object));
-                    m_btWorld->addRigidBody(obj->getRigid());
-                }
-                std::unique_lock<std::mutex> taskLock(m_decompositionTasksMutex);
-                m_decompositionTasks.push(std::make_tuple(obj, new_mesh));
-                m_decompositionCondVar.notify_one();
+                visible = false;
             }
-            else if (obj)
+        }
+        if(visible)
+        {
+            priority *= PRIORITY_VISIBLE;
+        }
+    }
+    return priority;
+}
+
+void gg::MCollisionResolver::releaseObject(MObject *obj)
+{
+    std::lock_guard<std::mutex> lock(m_subtractionTasksMutex);
+    m_busyObjects.erase(obj);
+    m_subtractionCondVar.notify_all();
+}
+
+void gg::MCollisionResolver::splitPieces(SplitTask &task)
+{
+    std::shared_ptr<Cut> cut;
+    MGeometry geometry;
+    bool remainder;
+    MeshManipulators::Cutter cutter;
+    std::tie(cut, geometry, remainder, cutter) = std::move(task);
+    MTraceSpan span("split", cut->flow, MTrace::Flow::STEP);
+    std::vector<std::shared_ptr<Piece>> pieces;
+    try
+    {
+        Timer t;
+        std::shared_ptr<const std::vector<MTriangleMesh>> cells(std::get<3>(cutter));
+        std::vector<MGeometry> parts;
+        if(cells && m_boolean != MSettings::Boolean::NEF && !geometry.hasNef())
+        {
+            //each cell is intersected with the triangle mesh in a task of its own, the tasks replace this one
+            //before it finishes; a cell the booleans refuse builds its own Nef polyhedron
+            MGeometry shared(geometry.meshOnly());
+            std::vector<MeshManipulators::Cutter> cellCutters;
+            for(auto &&cell : *cells)
+            {
+                cellCutters.push_back(cutter);
+                std::get<0>(cellCutters.back()) = std::shared_ptr<const MTriangleMesh>(cells, &cell);
+                std::get<3>(cellCutters.back()) = nullptr;
+            }
+            cut->pending += static_cast<int>(cellCutters.size());
+            for(auto &&cellCutter : cellCutters)
+            {
+                m_splitStage.push(std::make_tuple(cut, shared, remainder, std::move(cellCutter)));
+            }
+            finishUnits(cut, 1);
+            return;
+        }
+        if(cells)
+        {
+            parts = partition(geometry, cutter);
+        }
+        else if(std::get<0>(cutter))
+        {
+            parts = intersect(geometry, cutter).split();
+        }
+        else
+        {
+            parts = geometry.split();
+        }
+        for(auto &&part : parts)
+        {
+            if(part.empty())
             {
-                obj->deleted = true;
+                continue;
             }
+            pieces.push_back(std::make_shared<Piece>());
+            pieces.back()->geometry = std::move(part);
         }
+        m_telemetry.record(MTelemetry::Stage::SPLIT, t.elapsed());
+    }
+    catch(...)
+    {
+        std::cout << "FAILED\n";
+        pieces.clear();
+    }
+    {
+        //the parts of one cut are split in parallel, all of them add their pieces to the same cut
+        std::lock_guard<std::mutex> lock(cut->piecesMutex);
+        std::vector<std::shared_ptr<Piece>> &all = remainder ? cut->remainder : cut->debris;
+        all.insert(all.end(), pieces.begin(), pieces.end());
+    }
+    //every piece is converted on its own, the split is replaced by the conversions before any of them can finish
+    cut->pending += static_cast<int>(pieces.size());
+    for(auto &&piece : pieces)
+    {
+        m_meshStage.push(std::make_tuple(cut, piece));
+    }
+    finishUnits(cut, 1);
+}
+
+void gg::MCollisionResolver::convertPiece(MeshTask &task)
+{
+    std::shared_ptr<Cut> cut;
+    std::shared_ptr<Piece> piece;
+    std::tie(cut, piece) = std::move(task);
+    MTraceSpan span("meshConversion", cut->flow, MTrace::Flow::STEP);
+    try
+    {
+        Timer t;
+        std::tie(piece->mesh, piece->center) = piece->geometry.convertToMesh();
+        m_telemetry.record(MTelemetry::Stage::MESH_CONVERSION, t.elapsed());
+    }
+    catch(...)
+    {
+        std::cout << "FAILED\n";
+    }
+    if(piece->mesh)
+    {
+        //HACD needs only the mesh, it starts before the main thread has seen the piece
+        piece->decomposing = true;
+        m_decompositionStage.push(std::make_tuple(piece, Timer(), cut->flow));
+        m_telemetry.setGauge(MTelemetry::Gauge::DECOMPOSITION_QUEUE, m_decompositionStage.size());
+    }
+    finishUnits(cut, 1);
+}
+
+void gg::MCollisionResolver::decomposePiece(DecompositionTask &task, HacdThread &hacd)
+{
+    std::shared_ptr<Piece> piece;
+    Timer queued;
+    uint64_t flow;
+    std::tie(piece, queued, flow) = std::move(task);
+    MTraceSpan span("decomposition", flow, MTrace::Flow::STEP);
+    m_telemetry.record(MTelemetry::Stage::DECOMPOSITION_WAIT, queued.elapsed());
+    bool degraded = m_softLimit != 0 && m_decompositionStage.size() >= m_softLimit;
+    m_telemetry.setGauge(MTelemetry::Gauge::DECOMPOSITION_QUEUE, m_decompositionStage.size());
+    gg::Timer t;
+    btCollisionShape *triangles = MeshManipulators::convertMesh(piece->mesh);
+    btCollisionShape *shape = new btHACDCompoundShape(triangles, degraded ? hacd.fast : hacd.params);
+    shape->setMargin(0.01f);
+    delete static_cast<btBvhTriangleMeshShape *>(triangles)->getMeshInterface();
+    delete triangles;
+    m_telemetry.record(MTelemetry::Stage::HACD, t.elapsed());
+    //results are delivered in the order the workers finish them
+    m_decompositionResults.push(std::make_tuple(piece, shape, flow));
+}
+
+void gg::MCollisionResolver::finishUnits(const std::shared_ptr<Cut> &cut, int units)
+{
+    if(cut->pending.fetch_sub(units) == units)
+    {
+        m_subtractionResults.push(std::shared_ptr<Cut>(cut));
     }
+}
+
+size_t gg::MCollisionResolver::subtractionQueueDepth()
+{
+    std::lock_guard<std::mutex> taskLock(m_subtractionTasksMutex);
+    return m_subtractionTasks.size();
+}
+
+size_t gg::MCollisionResolver::decompositionQueueDepth()
+{
+    return m_decompositionStage.size();
+}
 
+size_t gg::MCollisionResolver::outstandingWork()
+{
+    size_t outstanding;
+    {
+        std::lock_guard<std::mutex> taskLock(m_subtractionTasksMutex);
+        outstanding = m_subtractionTasks.size() + m_busyObjects.size();
+    }
+    return outstanding + m_splitStage.size() + m_meshStage.size() + m_decompositionStage.size();
 }
 
-void gg::MCollisionResolver::decompositionApplier()
+void gg::MCollisionResolver::subtractionApplier(const Timer &frame)
 {
-    std::lock_guard<std::mutex> resLock(m_decompositionResultsMutex);
-    while(m_decompositionResults.size() > 0)
+    MTraceSpan span("subtractionApplier");
+    SubtractionResult result;
+    while(m_subtractionResults.pop(result))
     {
-        MObject* obj = NULL;
-        btCollisionShape* new_shape = NULL;
-        std::tie(obj, new_shape) = m_decompositionResults.front();
-        m_decompositionResults.pop();
-        if(obj && new_shape)
+        m_pendingSubtractions.push_back(std::move(result));
+    }
+    applyWithinBudget(m_pendingSubtractions, frame, [this](SubtractionResult &result) { applySubtraction(result); });
+}
+
+void gg::MCollisionResolver::applySubtraction(SubtractionResult &cut)
+{
+    MObject* target = cut->target;
+    MTraceSpan resultSpan("applySubtraction", cut->flow, MTrace::Flow::STEP);
+
+    Timer t;
+    std::shared_ptr<Piece> rest(cut->remainder.empty() ? nullptr : cut->remainder.front());
+    if(rest && rest->mesh)
+    {
+        long triangles = 0;
+        for(u32 i = 0; i < rest->mesh->getMeshBufferCount(); i++)
         {
-            delete obj->getRigid()->getCollisionShape();
-            obj->getRigid()->setCollisionShape(new_shape);
-            obj->reference_count--;
-            m_file_total << obj->m_timer.elapsed() << "\n";
+            triangles += rest->mesh->getMeshBuffer(i)->getIndexCount() / 3;
         }
+        m_telemetry.label(target, triangles, rest->geometry.vertexCount(), rest->geometry.facetCount());
     }
+    //debris is placed relative to the target as it was before this cut
+    for(auto &&piece : cut->remainder)
+    {
+        if(piece != rest)
+        {
+            applyDebris(target, *piece);
+        }
+    }
+    for(auto &&piece : cut->debris)
+    {
+        applyDebris(target, *piece);
+    }
+
+    if(rest && rest->mesh)
+    {
+        {
+            std::lock_guard<std::mutex> objLock(target->m_mutex);
+            target->setGeometry(std::move(rest->geometry));
+        }
+        IMeshSceneNode* Node = static_cast<IMeshSceneNode*>(target->getNode());
+        Node->setMesh(rest->mesh);
+        Node->setMaterialType(EMT_SOLID);
+        Node->setMaterialFlag(EMF_LIGHTING, 1);
+        Node->setMaterialFlag(EMF_NORMALIZE_NORMALS, true);
+        Node->setAutomaticCulling(irr::scene::EAC_OFF);
+        target->version++;
+        rest->object = target;
+        rest->version = target->version;
+        rest->applied = true;
+        releaseObject(target);
+        if(rest->decomposed)
+        {
+            installShape(*rest, rest->shape);
+        }
+    }
+    else
+    {
+        //nothing is left of the target
+        releaseObject(target);
+        target->deleted = true;
+        target->reference_count--;
+    }
+    m_telemetry.record(MTelemetry::Stage::APPLY, t.elapsed());
+}
+
+void gg::MCollisionResolver::applyDebris(MObject *target, Piece &piece)
+{
+    if(!piece.mesh)
+    {
+        return;
+    }
+    vector3df newPosition;
+    newPosition = quaternion(target->getNode()->getRelativeTransformation()) * piece.center;
+    newPosition += target->getNode()->getPosition();
+    btVector3 position(newPosition.X, newPosition.Y, newPosition.Z);
+    std::unique_ptr<MObject> object(m_objectCreator->createMeshRigidBodyWithTmpShape(piece.mesh, position, 10, target->getType(), std::move(piece.geometry)));
+    //the temporary shape is replaced once the decomposition of the piece is installed
+    object->reference_count++;
+    object->translation = piece.center;
+    object->m_timer = target->m_timer;
+    btTransform tr(target->getRigid()->getOrientation());
+    tr.setOrigin(position);
+    object->getRigid()->setWorldTransform(tr);
+    piece.object = object.get();
+    piece.version = object->version;
+    piece.applied = true;
+    m_btWorld->addRigidBody(object->getRigid());
+    m_objects->push_back(std::move(object));
+    if(piece.decomposed)
+    {
+        installShape(piece, piece.shape);
+    }
+}
+
+void gg::MCollisionResolver::decompositionApplier(const Timer &frame)
+{
+    MTraceSpan span("decompositionApplier");
+    DecompositionResult result;
+    while(m_decompositionResults.pop(result))
+    {
+        m_pendingDecompositions.push_back(std::move(result));
+    }
+    applyWithinBudget(m_pendingDecompositions, frame, [this](DecompositionResult &result) { applyDecomposition(result); });
+}
+
+void gg::MCollisionResolver::applyDecomposition(DecompositionResult &result)
+{
+    std::shared_ptr<Piece> piece;
+    btCollisionShape* new_shape = NULL;
+    uint64_t flow;
+    std::tie(piece, new_shape, flow) = result;
+    MTraceSpan resultSpan("applyDecomposition", flow, MTrace::Flow::END);
+    piece->decomposed = true;
+    if(piece->applied)
+    {
+        installShape(*piece, new_shape);
+    }
+    else
+    {
+        //the cut is still on its way to the main thread
+        piece->shape = new_shape;
+    }
+}
+
+void gg::MCollisionResolver::installShape(Piece &piece, btCollisionShape *shape)
+{
+    Timer t;
+    MObject* obj = piece.object;
+    piece.shape = nullptr;
+    if(obj->version == piece.version && !obj->deleted)
+    {
+        obj->setCollisionShape(shape);
+        m_telemetry.record(MTelemetry::Stage::APPLY, t.elapsed());
+        m_telemetry.record(MTelemetry::Stage::TOTAL, obj->m_timer.elapsed());
+    }
+    else
+    {
+        //a later cut has replaced the geometry, its own decomposition is on the way
+        delete shape;
+    }
+    obj->reference_count--;
+    retirePiece(piece);
+}
+
+void gg::MCollisionResolver::retirePiece(Piece &piece)
+{
+    //the scene node has its own reference, the decomposition worker reads the mesh until its result arrives
+    if(piece.mesh && piece.applied && (!piece.decomposing || piece.decomposed))
+    {
+        piece.mesh->drop();
+        piece.mesh = nullptr;
+    }
+}
+
+template<class Result, class Apply>
+void gg::MCollisionResolver::applyWithinBudget(std::vector<Result> &pending, const Timer &frame, Apply apply)
+{
+    if(pending.empty())
+    {
+        return;
+    }
+
+    //the oldest result always goes first, so results far from the camera are not postponed forever,
+    //the others are applied nearest to the camera first
+    std::vector<f32> distances;
+    distances.reserve(pending.size());
+    for(auto &&result : pending)
+    {
+        distances.push_back(cameraDistance(result));
+    }
+    std::vector<size_t> order(pending.size());
+    for(size_t i = 0; i < order.size(); i++)
+    {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin() + 1, order.end(), [&distances](size_t a, size_t b) { return distances[a] < distances[b]; });
+
+    std::vector<bool> applied(pending.size(), false);
+    for(size_t i = 0; i < order.size(); i++)
+    {
+        //at least one result per frame, whatever the budget
+        if(i > 0 && m_applyBudget > 0 && frame.elapsed() >= m_applyBudget)
+        {
+            break;
+        }
+        apply(pending[order[i]]);
+        applied[order[i]] = true;
+    }
+
+    size_t kept = 0;
+    for(size_t i = 0; i < pending.size(); i++)
+    {
+        if(!applied[i])
+        {
+            if(kept != i)
+            {
+                pending[kept] = std::move(pending[i]);
+            }
+            kept++;
+        }
+    }
+    pending.erase(pending.begin() + kept, pending.end());
+}
+
+f32 gg::MCollisionResolver::cameraDistance(const SubtractionResult &cut)
+{
+    return cameraDistance(cut->target);
+}
+
+f32 gg::MCollisionResolver::cameraDistance(const DecompositionResult &result)
+{
+    return cameraDistance(std::get<0>(result)->object);
+}
+
+f32 gg::MCollisionResolver::cameraDistance(MObject *obj)
+{
+    ICameraSceneNode* camera = m_irrDevice->getSceneManager()->getActiveCamera();
+    if(!camera || !obj || !obj->getNode())
+    {
+        return 0;
+    }
+    return camera->getAbsolutePosition().getDistanceFromSQ(obj->getNode()->getAbsolutePosition());
+}
+
+void gg::MCollisionResolver::forget(MObject *obj)
+{
+    m_telemetry.forget(obj);
+}
+
+void gg::MCollisionResolver::drain()
+{
+    MTraceSpan span("drain");
+    while(true)
+    {
+        bool idle;
+        {
+            std::lock_guard<std::mutex> lock(m_subtractionTasksMutex);
+            idle = m_subtractionTasks.empty() && m_busyObjects.empty();
+        }
+        //each stage is fed only by the ones before it, so they are checked in the order of the pipeline
+        idle = idle && m_splitStage.idle() && m_meshStage.idle() && m_decompositionStage.idle() && m_prefetchStage.idle();
+        Timer frame;
+        subtractionApplier(frame);
+        decompositionApplier(frame);
+        if(idle && m_pendingSubtractions.empty() && m_pendingDecompositions.empty() && subtractionQueueDepth() == 0)
+        {
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+void gg::MCollisionResolver::printStatistics(std::ostream &os, double seconds)
+{
+    m_telemetry.printSummary(os, seconds);
 }
 
 void gg::MCollisionResolver::resolveAll()
 {
+    MTraceSpan span("resolveAll");
 
     int numManifolds = m_btWorld->getDispatcher()->getNumManifolds();
     //For each contact manifold
@@ -331,8 +1163,12 @@ void gg::MCollisionResolver::resolveAll()
             }
         }
     }
-    subtractionApplier();
-    decompositionApplier();
+    //geometry changes are visible, they are applied before the collision shapes
+    Timer frame;
+    subtractionApplier(frame);
+    decompositionApplier(frame);
+    m_telemetry.setGauge(MTelemetry::Gauge::APPLY_BACKLOG, m_pendingSubtractions.size() + m_pendingDecompositions.size());
+    m_telemetry.maybeSnapshot();
 }
 
 //DUST GENERATOR
@@ -7,14 +7,22 @@
 #ifndef COLLISIONRESOLVER_H
 #define COLLISIONRESOLVER_H
 
+#include "Channel.h"
+#include "CutterLibrary.h"
+#include "FastBoolean.h"
+#include "Geometry.h"
 #include "Object.h"
 #include "ObjectCreator.h"
 #include "MeshManipulators.h"
+#include "Prefracture.h"
+#include "Settings.h"
+#include "Stage.h"
+#include "Telemetry.h"
+#include "Trace.h"
 
 #include <irrlicht.h>
 #include <btBulletCollisionCommon.h>
 #include <btBulletDynamicsCommon.h>
-#include <voro++/voro++.hh>
 
 #include <cstdlib>
 #include <utility>
@@ -25,8 +33,9 @@
 #include <deque>
 #include <atomic>
 #include <queue>
+#include <memory>
+#include <set>
 #include <condition_variable>
-#include <fstream>
 #include <iostream>
 
 namespace gg
@@ -37,46 +46,227 @@ namespace gg
 
     public:
         MCollisionResolver(irr::IrrlichtDevice *, btDiscreteDynamicsWorld *, MObjectCreator *,
-                           std::vector<std::unique_ptr<MObject>> *);
+                           std::vector<std::unique_ptr<MObject>> *, const MSettings &);
 
         ~MCollisionResolver();
 
         void resolveAll();
 
+        //prepares the exact geometry of the object the shot flies at, so that its first cut does not
+        //have to build it, main thread only
+        void prefetch(btVector3 position, btVector3 impulse);
+
+        //drops what is known about an object that is about to be destroyed, main thread only
+        void forget(MObject *obj);
+
+        //waits until every impact is cut and every piece is applied with its decomposition,
+        //main thread only
+        void drain();
+
+        void printStatistics(std::ostream &os, double seconds);
+
+        //number of objects waiting for a subtraction worker
+        size_t subtractionQueueDepth();
+
+        //number of meshes waiting for a decomposition worker
+        size_t decompositionQueueDepth();
+
     private:
+        //object, cutters at the impact positions relative to the object, time of enqueueing, trace flow id, priority
+        //all impacts on one object that are waiting for a worker are cut at once
+        typedef std::tuple<MObject *, std::vector<MeshManipulators::Cutter>, Timer, uint64_t, irr::f32> SubtractionTask;
+
+        //distance from the camera at which the priority of an impact halves
+        static constexpr irr::f32 PRIORITY_DISTANCE = 50;
+        //impacts in the view frustum count this many times more
+        static constexpr irr::f32 PRIORITY_VISIBLE = 4;
+        //seconds of waiting that double the priority of a task
+        static constexpr double PRIORITY_AGING = 0.5;
+
+        //one connected part of a cut, the stages fill it in one after another
+        struct Piece
+        {
+            MGeometry geometry;
+            irr::scene::IMesh *mesh = nullptr;
+            irr::core::vector3df center;
+            bool decomposing = false; //set by the mesh stage before the cut is complete
+
+            //main thread only
+            MObject *object = nullptr;
+            int version = 0; //version of the object the piece was applied as
+            btCollisionShape *shape = nullptr; //decomposition that arrived before the piece was applied
+            bool applied = false, decomposed = false;
+
+            //a piece dropped on the way, e.g. with the queues at shutdown, releases its mesh and shape
+            ~Piece();
+        };
+
+        //one subtraction, complete when all of its pieces have meshes
+        struct Cut
+        {
+            MObject *target;
+            std::vector<std::shared_ptr<Piece>> remainder, debris; //first piece of the remainder stays the target
+            std::mutex piecesMutex; //split tasks of one cut run in parallel
+            std::atomic<int> pending; //splits and mesh conversions not finished yet
+            uint64_t flow;
+        };
+
+        //cut, geometry to split, whether it is what remained of the target, shattering cutter whose
+        //cells the geometry is divided among first or a single cell it is intersected with (none otherwise)
+        typedef std::tuple<std::shared_ptr<Cut>, MGeometry, bool, MeshManipulators::Cutter> SplitTask;
+
+        typedef std::tuple<std::shared_ptr<Cut>, std::shared_ptr<Piece>> MeshTask;
+
+        //piece, time of enqueueing, trace flow id
+        typedef std::tuple<std::shared_ptr<Piece>, Timer, uint64_t> DecompositionTask;
+
+        typedef std::shared_ptr<Cut> SubtractionResult;
+
+        //piece, its collision shape, trace flow id
+        typedef std::tuple<std::shared_ptr<Piece>, btCollisionShape *, uint64_t> DecompositionResult;
+
+        //every thread that runs CGAL, the subtraction workers included: CGAL's interval filters expect
+        //round to nearest outside of their own protected sections, a new thread copies the mode of the
+        //thread that created it, so the mode is set here instead of depending on whatever that was
+        struct CgalThread
+        {
+            CgalThread();
+        };
+
+        //HACD allocates from a heap manager, every worker keeps its own for all its decompositions
+        struct HacdThread
+        {
+            HacdThread();
+
+            ~HacdThread();
+
+            btHACDCompoundShape::Params params;
+            btHACDCompoundShape::Params fast; //coarser decomposition used while the queue is over the soft limit
+        };
+
         void resolveCollision(MObject *object, btVector3 point, btScalar impulse,
                               MObject *other_object);
 
-        void meshSubtractor(); //thread
+        //detaches the precomputed chunks of the object around the impact instead of cutting it, false when
+        //the pattern of the object is not ready yet or the object has been cut since it was loaded
+        bool detachChunks(MObject *obj, const irr::core::vector3df &impact, irr::f32 radius);
+
+        //replaces the mesh and the shape of the object by those of its chunks
+        void attachChunks(MObject *obj, const MPrefracture &prefracture);
+
+        void meshSubtractor(); //thread, one per worker of the pool
+
+        //what remains of the geometry and the parts cut off, with the selected booleans when they
+        //can handle the cut, otherwise on Nef polyhedra
+        std::tuple<MGeometry, std::vector<MGeometry>> subtract(MGeometry &geometry,
+                                                                const std::vector<MeshManipulators::Cutter> &cutters);
+
+        //the parts of the geometry in the cells of the shattering cutter, from one overlay of its Nef
+        //polyhedron with the walls of the cells; every part is connected
+        std::vector<MGeometry> partition(MGeometry &geometry, const MeshManipulators::Cutter &shatter);
 
-        void meshDecomposer(); //thread
+        //the part of the geometry inside the cutter, with the selected booleans when they can handle it
+        MGeometry intersect(MGeometry &geometry, const MeshManipulators::Cutter &cutter);
 
-        void subtractionApplier(); // every loop
+        //queued task of the object, expects m_subtractionTasksMutex
+        std::deque<SubtractionTask>::iterator pendingSubtractionTask(MObject *obj);
 
-        void decompositionApplier(); //must be called every loop
+        //adds cutters to a queued task, a task with several cutters cuts its pieces off whole
+        static void mergeCutters(std::vector<MeshManipulators::Cutter> &pending,
+                                 std::vector<MeshManipulators::Cutter> cutters);
+
+        //queued task with the highest aged priority whose object is not being cut by another worker,
+        //expects m_subtractionTasksMutex
+        std::deque<SubtractionTask>::iterator nextSubtractionTask();
+
+        static irr::f32 agedPriority(const SubtractionTask &task);
+
+        //impacts waiting for or being cut plus pieces waiting for the split, mesh and decomposition stages,
+        //compared with the soft and hard limits
+        size_t outstandingWork();
+
+        //makes room for an impact over the hard limit by dropping the weakest queued task,
+        //false when the new impact is the weakest, expects m_subtractionTasksMutex
+        bool admit(irr::f32 priority);
+
+        //impulse weighted by the distance from the camera and visibility, main thread only
+        irr::f32 impactPriority(const irr::core::vector3df &point, btScalar impulse);
+
+        //lets the workers pick up the next task of the object
+        void releaseObject(MObject *obj);
+
+        //split stage; the cells of a shattering impact divide a Nef polyhedron in the task itself,
+        //a triangle mesh is shared by one task per cell
+        void splitPieces(SplitTask &task);
+
+        void convertPiece(MeshTask &task); //mesh stage
+
+        void decomposePiece(DecompositionTask &task, HacdThread &hacd); //decomposition stage
+
+        //builds the representation the booleans need from the triangle mesh of the object, prefetch stage
+        void prefetchGeometry(MObject *obj);
+
+        //counts a finished split or conversion, the last one hands the cut to the main thread
+        void finishUnits(const std::shared_ptr<Cut> &cut, int units);
+
+        void subtractionApplier(const Timer &frame); // every loop
+
+        void applySubtraction(SubtractionResult &cut);
+
+        //places the piece in the scene as a new object
+        void applyDebris(MObject *target, Piece &piece);
+
+        void decompositionApplier(const Timer &frame); //must be called every loop
+
+        void applyDecomposition(DecompositionResult &result);
+
+        //replaces the temporary shape of the applied piece, unless the object has been cut again since
+        void installShape(Piece &piece, btCollisionShape *shape);
+
+        //drops the mesh of a piece once nothing uses it any more
+        static void retirePiece(Piece &piece);
+
+        //applies pending results until the time measured by frame exceeds the budget, the rest waits for the next frame
+        template<class Result, class Apply>
+        void applyWithinBudget(std::vector<Result> &pending, const Timer &frame, Apply apply);
+
+        //squared distance between the active camera and the object
+        irr::f32 cameraDistance(MObject *obj);
+
+        irr::f32 cameraDistance(const SubtractionResult &cut);
+
+        irr::f32 cameraDistance(const DecompositionResult &result);
 
         irr::IrrlichtDevice *m_irrDevice;
         btDiscreteDynamicsWorld *m_btWorld;
         MObjectCreator *m_objectCreator;
         std::vector<std::unique_ptr<MObject>> *m_objects;
-        std::deque<std::tuple<MObject *, irr::scene::IMesh *, irr::core::vector3df>> m_subtractionTasks;
-        std::queue<std::tuple<MObject *, btVector3, btQuaternion, MeshManipulators::Nef_polyhedron,
-                                            irr::scene::IMesh *, int>> m_subtractionResults;
+        //the last element of the tuples is the trace flow id of the impact
+        std::deque<SubtractionTask> m_subtractionTasks;
+        //workers hand their results to the main thread without locking, the main thread is the only consumer
+        MChannel<SubtractionResult> m_subtractionResults;
         std::mutex m_subtractionTasksMutex;
-        std::mutex m_subtractionResultsMutex;
         std::condition_variable m_subtractionCondVar;
-        std::queue<std::tuple<MObject *, irr::scene::IMesh *>> m_decompositionTasks;
-        std::queue<std::tuple<MObject *, btCollisionShape *>> m_decompositionResults;
-        std::mutex m_decompositionTasksMutex;
-        std::mutex m_decompositionResultsMutex;
-        std::condition_variable m_decompositionCondVar;
-        std::thread m_subtractor;
-        std::thread m_decomposer;
+        MChannel<DecompositionResult> m_decompositionResults;
+        std::set<MObject *> m_busyObjects; //guarded by m_subtractionTasksMutex
+        std::vector<std::thread> m_subtractors;
         std::atomic<bool> m_done;
 
-        std::ofstream m_file_subtraction;
-        std::ofstream m_file_decomposition;
-        std::ofstream m_file_total;
+        //results taken from the workers but not yet applied, main thread only
+        std::vector<SubtractionResult> m_pendingSubtractions;
+        std::vector<DecompositionResult> m_pendingDecompositions;
+        const double m_applyBudget; //seconds per frame, 0 is unlimited
+        const unsigned m_softLimit, m_hardLimit; //outstanding tasks, 0 is unlimited
+        const MSettings::Boolean m_boolean;
+        MCutterLibrary m_cutters; //main thread only
+
+        MTelemetry m_telemetry;
+
+        //subtraction -> split -> mesh conversion -> decomposition, the stages are stopped in this order
+        MStage<SplitTask, CgalThread> m_splitStage;
+        MStage<MeshTask, CgalThread> m_meshStage;
+        MStage<DecompositionTask, HacdThread> m_decompositionStage;
+        MStage<MObject *, CgalThread> m_prefetchStage;
     };
 
 
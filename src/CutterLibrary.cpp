@@ -0,0 +1,181 @@
+#include "CutterLibrary.h"
+#include "VertexWelder.h"
+
+#include <voro++/voro++.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+gg::MCutterLibrary::MCutterLibrary(unsigned seed, unsigned shatterCells) : m_random(seed)
+{
+    for(int i = 0; i < CLASSES; i++)
+    {
+        std::vector<std::shared_ptr<const MTriangleMesh>> cells;
+        for(int j = 0; j < VARIANTS; j++)
+        {
+            cells.push_back(makeCell(SMALLEST * std::pow(2.0, i), 2));
+        }
+        m_cells.push_back(std::move(cells));
+    }
+    m_cube = makeCell(1, 0);
+    for(int i = 0; shatterCells > 1 && i < VARIANTS; i++)
+    {
+        m_complexes.push_back(makeComplex(1.01, shatterCells));
+    }
+}
+
+std::shared_ptr<const gg::MTriangleMesh> gg::MCutterLibrary::makeCell(double size, int seeds)
+{
+    using namespace voro;
+    std::uniform_real_distribution<double> coordinate(-size, size);
+    container con(-size, size, -size, size, -size, size,
+                  8, 8, 8,
+                  false, false, false,
+                  8);
+    con.put(0, 0, 0, 0);
+    for(int i = 1; i <= seeds; i++)
+    {
+        con.put(i, coordinate(m_random), coordinate(m_random), coordinate(m_random));
+    }
+    c_loop_all loop(con);
+    loop.start();
+    voronoicell c;
+    con.compute_cell(c, loop);
+    return std::make_shared<const MTriangleMesh>(MeshManipulators::convertToTriangleMesh(c, 0, 0, 0));
+}
+
+std::shared_ptr<const std::vector<gg::MTriangleMesh>> gg::MCutterLibrary::makeComplex(double size, unsigned seeds)
+{
+    using namespace voro;
+    std::uniform_real_distribution<double> coordinate(-size, size);
+    container con(-size, size, -size, size, -size, size,
+                  4, 4, 4,
+                  false, false, false,
+                  8);
+    con.put(0, 0, 0, 0);
+    for(unsigned i = 1; i < seeds; i++)
+    {
+        con.put(static_cast<int>(i), coordinate(m_random), coordinate(m_random), coordinate(m_random));
+    }
+    std::vector<std::vector<double>> positions;
+    std::vector<std::vector<int>> faces;
+    size_t corners = 0;
+    c_loop_all loop(con);
+    voronoicell c;
+    if(loop.start())
+    {
+        do
+        {
+            if(con.compute_cell(c, loop))
+            {
+                double x, y, z;
+                loop.pos(x, y, z);
+                positions.emplace_back();
+                faces.emplace_back();
+                c.vertices(x, y, z, positions.back());
+                c.face_vertices(faces.back());
+                corners += positions.back().size() / 3;
+            }
+        } while(loop.inc());
+    }
+
+    //the cells are computed one by one, so the corners they share are welded and every face is fanned
+    //from its lowest welded corner, then neighbouring cells have exactly the same triangles in their wall
+    MTriangleMesh welded;
+    MVertexWelder welder(welded, corners, size * 1e-9);
+    std::shared_ptr<std::vector<MTriangleMesh>> cells(std::make_shared<std::vector<MTriangleMesh>>());
+    for(size_t k = 0; k < positions.size(); k++)
+    {
+        std::vector<uint32_t> global;
+        for(size_t i = 0; i < positions[k].size(); i += 3)
+        {
+            global.push_back(welder.add(positions[k][i], positions[k][i + 1], positions[k][i + 2]));
+        }
+        MTriangleMesh mesh;
+        std::unordered_map<uint32_t, uint32_t> local;
+        auto vertex = [&](uint32_t id)
+        {
+            auto inserted = local.emplace(id, static_cast<uint32_t>(mesh.vertexCount()));
+            if(inserted.second)
+            {
+                mesh.vertices.insert(mesh.vertices.end(), &welded.vertices[3 * size_t(id)],
+                                     &welded.vertices[3 * size_t(id)] + 3);
+            }
+            return inserted.first->second;
+        };
+        const std::vector<int> &face_vertices = faces[k];
+        for(size_t i = 0; i < face_vertices.size(); i += face_vertices[i] + 1)
+        {
+            //corners welded together are dropped, faces left with less than three are gone
+            std::vector<uint32_t> face;
+            for(int j = 0; j < face_vertices[i]; j++)
+            {
+                uint32_t id = global[static_cast<size_t>(face_vertices[i + j + 1])];
+                if(face.empty() || face.back() != id)
+                {
+                    face.push_back(id);
+                }
+            }
+            while(face.size() > 1 && face.back() == face.front())
+            {
+                face.pop_back();
+            }
+            if(face.size() < 3)
+            {
+                continue;
+            }
+            std::rotate(face.begin(), std::min_element(face.begin(), face.end()), face.end());
+            for(size_t j = 1; j + 1 < face.size(); j++)
+            {
+                mesh.indices.push_back(vertex(face[0]));
+                mesh.indices.push_back(vertex(face[j]));
+                mesh.indices.push_back(vertex(face[j + 1]));
+            }
+        }
+        if(mesh.volume() < 0)
+        {
+            for(size_t i = 0; i < mesh.indices.size(); i += 3)
+            {
+                std::swap(mesh.indices[i + 1], mesh.indices[i + 2]);
+            }
+        }
+        cells->push_back(std::move(mesh));
+    }
+    return cells;
+}
+
+gg::MeshManipulators::Cutter gg::MCutterLibrary::cutter(irr::f32 size, const irr::core::vector3df &position, bool plain)
+{
+    irr::core::matrix4 scale;
+    if(plain)
+    {
+        scale.setScale(size);
+        return std::make_tuple(m_cube, position, scale, nullptr);
+    }
+    int sizeClass = static_cast<int>(std::lround(std::log2(std::max(size, SMALLEST) / SMALLEST)));
+    sizeClass = std::min(sizeClass, CLASSES - 1);
+    std::uniform_real_distribution<irr::f32> angle(0, 360), jitter(0.85f, 1.15f);
+    std::uniform_int_distribution<int> variant(0, VARIANTS - 1);
+    scale.setScale(size / (SMALLEST * static_cast<irr::f32>(1 << sizeClass)) * jitter(m_random));
+    irr::core::matrix4 transform;
+    transform.setRotationDegrees(irr::core::vector3df(angle(m_random), angle(m_random), angle(m_random)));
+    transform *= scale;
+    return std::make_tuple(m_cells[sizeClass][variant(m_random)], position, transform, nullptr);
+}
+
+gg::MeshManipulators::Cutter gg::MCutterLibrary::shatter(irr::f32 size, const irr::core::vector3df &position)
+{
+    if(m_complexes.empty())
+    {
+        return cutter(size, position, false);
+    }
+    std::uniform_real_distribution<irr::f32> angle(0, 360);
+    std::uniform_int_distribution<size_t> variant(0, m_complexes.size() - 1);
+    irr::core::matrix4 scale;
+    scale.setScale(size);
+    irr::core::matrix4 transform;
+    transform.setRotationDegrees(irr::core::vector3df(angle(m_random), angle(m_random), angle(m_random)));
+    transform *= scale;
+    return std::make_tuple(m_cube, position, transform, m_complexes[variant(m_random)]);
+}
@@ -0,0 +1,57 @@
+/*
+ * cells that cut objects at the impacts, generated once when the resolver is created.
+ * The cells are sorted into size classes whose sizes double from one class to the next. An impact takes
+ * a random cell of the nearest class and only picks a random rotation and scale for it, so the main thread
+ * computes no geometry per impact and the workers share the meshes of the cells without copying them.
+ * For shattering, the library also keeps complexes of cells that partition a cube around the impact.
+ */
+
+#ifndef CUTTERLIBRARY_H
+#define CUTTERLIBRARY_H
+
+#include "MeshManipulators.h"
+#include "TriangleMesh.h"
+
+#include <irrlicht.h>
+
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace gg
+{
+
+    class MCutterLibrary
+    {
+    public:
+        //complexes of shatterCells cells are generated only for more than one cell
+        explicit MCutterLibrary(unsigned seed, unsigned shatterCells = 0);
+
+        //cell of about size half extent at the position, the plain cube has the fewest faces to intersect
+        MeshManipulators::Cutter cutter(irr::f32 size, const irr::core::vector3df &position, bool plain);
+
+        //cube of about size half extent at the position with the cells it is shattered into,
+        //the plain cutter when there are no complexes
+        MeshManipulators::Cutter shatter(irr::f32 size, const irr::core::vector3df &position);
+
+    private:
+        static constexpr irr::f32 SMALLEST = 0.5f; //half extent of the cells of the first class
+        static constexpr int CLASSES = 9;
+        static constexpr int VARIANTS = 16; //cells per class
+
+        //cell of the centre of a cube of the half extent with a few more random seeds in it
+        std::shared_ptr<const MTriangleMesh> makeCell(double size, int seeds);
+
+        //all cells of random seeds in a cube of the half extent, the first seed is at the centre
+        std::shared_ptr<const std::vector<MTriangleMesh>> makeComplex(double size, unsigned seeds);
+
+        std::vector<std::vector<std::shared_ptr<const MTriangleMesh>>> m_cells; //by size class
+        std::shared_ptr<const MTriangleMesh> m_cube; //half extent 1
+        //slightly larger than the cube, so the cells cover the part the cube cuts out without sharing its faces
+        std::vector<std::shared_ptr<const std::vector<MTriangleMesh>>> m_complexes;
+        std::minstd_rand m_random;
+    };
+
+}
+
+#endif // CUTTERLIBRARY_H
@@ -0,0 +1,1777 @@
+#include "FastBoolean.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace
+{
+    struct Vec
+    {
+        double x, y, z;
+    };
+
+    inline Vec operator+(Vec a, Vec b)
+    { return {a.x + b.x, a.y + b.y, a.z + b.z}; }
+
+    inline Vec operator-(Vec a, Vec b)
+    { return {a.x - b.x, a.y - b.y, a.z - b.z}; }
+
+    inline Vec operator*(Vec a, double s)
+    { return {a.x * s, a.y * s, a.z * s}; }
+
+    inline double dot(Vec a, Vec b)
+    { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+    inline Vec cross(Vec a, Vec b)
+    { return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x}; }
+
+    inline Vec absolute(Vec a)
+    { return {std::abs(a.x), std::abs(a.y), std::abs(a.z)}; }
+
+    inline double length(Vec a)
+    { return std::sqrt(dot(a, a)); }
+
+    //bounds the components of the cross product by magnitude, the rounding of each is relative to them
+    inline Vec crossBound(Vec a, Vec b)
+    {
+        a = absolute(a);
+        b = absolute(b);
+        return {a.y * b.z + a.z * b.y, a.z * b.x + a.x * b.z, a.x * b.y + a.y * b.x};
+    }
+
+    //points with negative distance are inside
+    struct Plane
+    {
+        Vec normal;
+        double offset;
+
+        inline double distance(Vec p) const
+        { return dot(normal, p) - offset; }
+    };
+
+    const uint32_t NONE = UINT32_MAX;
+
+    //unit roundoff, every operation on doubles is off by at most this much relative to its exact result
+    const double EPSILON = std::numeric_limits<double>::epsilon() / 2;
+    //relative to the largest coordinate, a constructed vertex whose error bound is larger is refused,
+    //the signs stay certified beyond it but the result would be placed too coarsely
+    const double PRECISION = 1e-8;
+    //relative to the square of the largest coordinate, a smaller cutter triangle is left out of the cutter
+    const double MIN_AREA = 1e-8;
+    //triangles of one cutter face differ by the rounding of the cutter vertices to floats
+    const double COPLANAR = 1e-5;
+
+    //how a constructed vertex was made, so that every construction happens once
+    enum Kind : uint32_t
+    {
+        EDGE_PLANE, TRIANGLE_PLANES
+    };
+
+    struct Key
+    {
+        uint32_t kind, a, b, c;
+
+        inline bool operator==(const Key &other) const
+        { return kind == other.kind && a == other.a && b == other.b && c == other.c; }
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key &key) const
+        {
+            uint64_t h = key.kind;
+            for(uint64_t value : {key.a, key.b, key.c})
+            {
+                h = (h ^ value) * 0x9E3779B97F4A7C15ull;
+                h ^= h >> 29;
+            }
+            return static_cast<size_t>(h);
+        }
+    };
+
+    //edge of a polygon, a part of the solid edge (a, b), a line on the cutter plane a,
+    //or a bridge between the boundary of a polygon and its hole
+    struct Source
+    {
+        uint32_t a, b;
+
+        inline bool onPlane() const
+        { return b == NONE && a != NONE; }
+
+        inline bool bridge() const
+        { return a == NONE; }
+    };
+
+    const Source BRIDGE = {NONE, NONE};
+
+    //bound on the relative error of n operations in a row (Higham)
+    inline double gamma(int n)
+    { return n * EPSILON / (1 - n * EPSILON); }
+
+    //1 or -1 when the value is farther from zero than its error bound, 0 when the sign is not certain
+    inline int sign(double value, double error)
+    { return value > error ? 1 : value < -error ? -1 : 0; }
+
+    //point in a plane, both coordinates known to within the error
+    struct Planar
+    {
+        double x, y, error;
+    };
+
+    //twice the signed area of the triangle, positive counter-clockwise, off by at most the returned error
+    inline double orient(const Planar &a, const Planar &b, const Planar &c, double &error)
+    {
+        double dx1 = b.x - a.x, dy1 = b.y - a.y, dx2 = c.x - a.x, dy2 = c.y - a.y;
+        //the differences carry the errors of their ends and their own rounding
+        double ex1 = a.error + b.error + EPSILON * std::abs(dx1), ey1 = a.error + b.error + EPSILON * std::abs(dy1);
+        double ex2 = a.error + c.error + EPSILON * std::abs(dx2), ey2 = a.error + c.error + EPSILON * std::abs(dy2);
+        double left = dx1 * dy2, right = dy1 * dx2;
+        error = std::abs(dx1) * ey2 + std::abs(dy2) * ex1 + ex1 * ey2 + std::abs(dy1) * ex2 + std::abs(dx2) * ey1 + ey1 * ex2
+                + 2 * EPSILON * (std::abs(left) + std::abs(right));
+        //the bound is rounded as well, it is enlarged by more than that
+        error *= 1 + gamma(16);
+        return left - right;
+    }
+
+    //part of a solid triangle that lies entirely inside or outside the cutter,
+    //only the part inside is known to be convex
+    struct Polygon
+    {
+        uint32_t triangle;
+        bool inside;
+        std::vector<uint32_t> points;
+        std::vector<Source> sources;
+
+        Polygon(uint32_t triangle, bool inside) : triangle(triangle), inside(inside)
+        {}
+
+        //a repeated point only takes over the source of the next edge
+        inline void append(uint32_t point, Source source)
+        {
+            if(!points.empty() && points.back() == point)
+            {
+                sources.back() = source;
+                return;
+            }
+            add(point, source);
+        }
+
+        inline void add(uint32_t point, Source source)
+        {
+            points.push_back(point);
+            sources.push_back(source);
+        }
+    };
+
+    //face of the cutter, counter-clockwise seen from outside, planes[i] meets the face along points[i], points[i + 1]
+    struct Face
+    {
+        std::vector<uint32_t> points;
+        std::vector<uint32_t> planes;
+    };
+
+    //position of a point along a line, known to within the error
+    struct Along
+    {
+        double position, error;
+        uint32_t point;
+
+        inline bool operator<(const Along &other) const
+        { return position < other.position; }
+    };
+
+    //vertices of the solid followed by the points constructed by the cut, the vertices are read from the solid
+    class Points
+    {
+    public:
+        explicit Points(const gg::MTriangleMesh &solid)
+            : m_solid(solid), m_solidCount(static_cast<uint32_t>(solid.vertexCount()))
+        {}
+
+        inline Vec operator[](uint32_t point) const
+        {
+            if(point < m_solidCount)
+            {
+                const double *v = &m_solid.vertices[point * 3];
+                return {v[0], v[1], v[2]};
+            }
+            return m_constructed[point - m_solidCount];
+        }
+
+        //distance from the exact point it stands for, zero for the vertices of the solid
+        inline double error(uint32_t point) const
+        { return point < m_solidCount ? 0 : m_errors[point - m_solidCount]; }
+
+        inline void widen(uint32_t point, double error)
+        { m_errors[point - m_solidCount] = std::max(m_errors[point - m_solidCount], error); }
+
+        inline uint32_t add(Vec position, double error)
+        {
+            m_constructed.push_back(position);
+            m_errors.push_back(error);
+            return size() - 1;
+        }
+
+        inline uint32_t size() const
+        { return m_solidCount + static_cast<uint32_t>(m_constructed.size()); }
+
+        inline uint32_t solidCount() const
+        { return m_solidCount; }
+
+    private:
+        const gg::MTriangleMesh &m_solid;
+        uint32_t m_solidCount;
+        std::vector<Vec> m_constructed;
+        std::vector<double> m_errors;
+    };
+
+    //coordinates of points on a plane, perpendicular to the normal
+    class Projection
+    {
+    public:
+        Projection(const Points &points, Vec normal) : m_points(points)
+        {
+            m_u = cross(normal, std::abs(normal.x) < 0.9 * length(normal) ? Vec{1, 0, 0} : Vec{0, 1, 0});
+            m_u = m_u * (1 / length(m_u));
+            m_v = cross(normal, m_u);
+            m_v = m_v * (1 / length(m_v));
+        }
+
+        inline double x(uint32_t point) const
+        { return dot(m_points[point], m_u); }
+
+        inline double y(uint32_t point) const
+        { return dot(m_points[point], m_v); }
+
+        //the axes are taken as exact, the coordinates carry the error of the point and the rounding of the projection
+        inline Planar planar(uint32_t point) const
+        {
+            return {x(point), y(point), m_points.error(point) * (1 + gamma(4)) + gamma(5) * length(m_points[point])};
+        }
+
+        inline double orient(uint32_t a, uint32_t b, uint32_t c, double &error) const
+        { return ::orient(planar(a), planar(b), planar(c), error); }
+
+        inline int side(uint32_t a, uint32_t b, uint32_t c) const
+        {
+            double error;
+            double value = orient(a, b, c, error);
+            return sign(value, error);
+        }
+
+    private:
+        const Points &m_points;
+        Vec m_u, m_v;
+    };
+
+    class Subtraction
+    {
+    public:
+        Subtraction(const gg::MTriangleMesh &solid, const gg::MTriangleIndex &index, const gg::MTriangleMesh &cutter)
+            : m_solid(solid), m_cutter(cutter), m_index(index), m_points(solid)
+        {}
+
+        //cuts the patch around the cutter and closes both parts, returns the part of the solid inside the cutter
+        gg::MTriangleMesh run();
+
+        //puts the new triangles of the difference in place of the patch, in the solid and in its index
+        void splice(gg::MTriangleMesh &solid, gg::MTriangleIndex &index) const;
+
+    private:
+        typedef gg::MFastBoolean::Degenerate Degenerate;
+
+        inline Vec vertex(const gg::MTriangleMesh &mesh, uint32_t i) const
+        { return {mesh.vertices[i * 3], mesh.vertices[i * 3 + 1], mesh.vertices[i * 3 + 2]}; }
+
+        //true when the point is outside the plane, throws Degenerate when the error bound does not tell
+        bool outside(uint32_t point, uint32_t plane) const;
+
+        //the exact point may lie off the plane a by up to the given distance, the error covers that as well
+        Vec intersect(const Plane &a, const Plane &b, const Plane &c, double &error, double offPlane = 0) const;
+
+        uint32_t addPoint(const Key &key, Vec position, double error);
+
+        uint32_t edgePoint(uint32_t a, uint32_t b, uint32_t plane);
+
+        const Plane &trianglePlane(uint32_t triangle);
+
+        uint32_t linePoint(uint32_t triangle, uint32_t p, uint32_t q);
+
+        //more than three planes may meet at a cutter vertex, so the vertices are told apart by position
+        uint32_t cutterVertex(uint32_t p, uint32_t q, uint32_t r);
+
+        inline uint32_t crossing(uint32_t triangle, Source source, uint32_t plane)
+        {
+            return source.onPlane() ? linePoint(triangle, source.a, plane) : edgePoint(source.a, source.b, plane);
+        }
+
+        void buildPlanes();
+
+        void buildFaces();
+
+        bool nearCutter(uint32_t triangle) const;
+
+        //throws Degenerate when the point is not certainly away from the line between from and to
+        Along along(uint32_t from, uint32_t to, uint32_t point) const;
+
+        //casts a ray from the point, throws Degenerate when a crossing is not certain
+        bool insideSolid(uint32_t point) const;
+
+        Polygon wholeTriangle(uint32_t triangle, bool inside) const;
+
+        void clipTriangle(uint32_t triangle);
+
+        void splitOutside(const Polygon &inside);
+
+        void traceSegments(uint32_t triangle);
+
+        void emit(const Polygon &polygon);
+
+        void classifyCutterVertices();
+
+        void closeFace(uint32_t plane);
+
+        void triangulate(uint32_t plane, std::vector<std::vector<uint32_t>> loops);
+
+        //triangulates a simple polygon, counter-clockwise around the normal, by ear clipping
+        void clipEars(std::vector<uint32_t> ring, Vec normal, std::vector<uint32_t> &target,
+                      std::vector<uint32_t> *reversed);
+
+        //the solid was closed and the kept triangles are unchanged, so it is enough to check
+        //that the new triangles close the hole left by the replaced ones
+        void checkPatch(const std::vector<uint32_t> &replaced) const;
+
+        gg::MTriangleMesh collect(const std::vector<uint32_t> &triangles) const;
+
+        const gg::MTriangleMesh &m_solid;
+        const gg::MTriangleMesh &m_cutter;
+        double m_scale = 0;
+
+        const gg::MTriangleIndex &m_index;
+        Points m_points;
+        std::unordered_map<Key, uint32_t, KeyHash> m_keys;
+        //points constructed on a solid edge and on the line where a solid triangle meets a cutter plane,
+        //a polygon whose edge passes through them has to use them as vertices to avoid T-junctions
+        std::unordered_map<uint64_t, std::vector<uint32_t>> m_edgePoints;
+        std::unordered_map<uint64_t, std::vector<uint32_t>> m_linePoints;
+
+        std::vector<Plane> m_planes;
+        std::vector<Face> m_faces;
+        std::vector<uint32_t> m_cutterVertices;
+        Vec m_cutterMin, m_cutterMax, m_solidMin, m_solidMax;
+        double m_cutterError = 0;
+        //plane of the triangle being clipped, computed only when a point on it is needed,
+        //the triangle lies within the error of it
+        uint32_t m_planeTriangle = NONE;
+        Plane m_trianglePlane;
+        double m_trianglePlaneError = 0;
+        //emitted once all points are known
+        std::vector<Polygon> m_polygons;
+        //vertices of some polygon, only those are put on the edges of the others
+        std::unordered_set<uint32_t> m_used;
+
+        //parts of the solid surface crossing each cutter face, directed with the solid on the left
+        std::vector<std::vector<std::pair<uint32_t, uint32_t>>> m_segments;
+        //for each face, where the solid surface crosses its edge with another plane
+        std::vector<std::unordered_map<uint32_t, std::vector<uint32_t>>> m_crossings;
+        std::unordered_map<uint32_t, bool> m_cutterInside;
+
+        //triangles of the solid replaced by the new ones, the others are kept as they are
+        std::vector<uint32_t> m_replaced, m_difference, m_intersection;
+    };
+
+    bool Subtraction::outside(uint32_t point, uint32_t plane) const
+    {
+        const Plane &p = m_planes[plane];
+        Vec v = m_points[point];
+        double distance = p.distance(v);
+        //the rounding of the dot product and the subtraction, and the error of the point along the unit normal
+        double error = gamma(5) * (dot(absolute(p.normal), absolute(v)) + std::abs(p.offset))
+                       + m_points.error(point) * (1 + gamma(4));
+        if(std::abs(distance) <= error)
+        {
+            throw Degenerate("point too close to a cutter plane");
+        }
+        return distance > 0;
+    }
+
+    Vec Subtraction::intersect(const Plane &a, const Plane &b, const Plane &c, double &error, double offPlane) const
+    {
+        //Cramer's rule, the rounding of every cross product is bounded by the same products of magnitudes
+        Vec bc = cross(b.normal, c.normal), ca = cross(c.normal, a.normal), ab = cross(a.normal, b.normal);
+        Vec bcBound = crossBound(b.normal, c.normal), caBound = crossBound(c.normal, a.normal),
+            abBound = crossBound(a.normal, b.normal);
+        double determinant = dot(a.normal, bc);
+        double determinantError = gamma(6) * dot(absolute(a.normal), bcBound);
+        if(std::abs(determinant) <= determinantError)
+        {
+            throw Degenerate("planes almost parallel");
+        }
+        Vec position = (bc * a.offset + ca * b.offset + ab * c.offset) * (1 / determinant);
+        Vec numeratorError = (bcBound * std::abs(a.offset) + caBound * std::abs(b.offset) + abBound * std::abs(c.offset))
+                             * gamma(6);
+        //moving the plane a moves the point along bc
+        double lower = std::abs(determinant) - determinantError;
+        Vec positionError = (numeratorError + absolute(position) * determinantError + bcBound * offPlane) * (1 / lower)
+                            + absolute(position) * gamma(3);
+        error = length(positionError) * (1 + gamma(4));
+        return position;
+    }
+
+    uint32_t Subtraction::addPoint(const Key &key, Vec position, double error)
+    {
+        if(error > PRECISION * m_scale)
+        {
+            throw Degenerate("constructed vertex too inaccurate");
+        }
+        uint32_t index = m_points.add(position, error);
+        m_keys.emplace(key, index);
+        return index;
+    }
+
+    uint32_t Subtraction::edgePoint(uint32_t a, uint32_t b, uint32_t plane)
+    {
+        //both triangles of the edge have to construct the same point
+        Key key{EDGE_PLANE, std::min(a, b), std::max(a, b), plane};
+        auto found = m_keys.find(key);
+        if(found != m_keys.end())
+        {
+            return found->second;
+        }
+        const Plane &p = m_planes[plane];
+        Vec from = m_points[key.a], to = m_points[key.b];
+        double distanceFrom = p.distance(from), distanceTo = p.distance(to);
+        double errorFrom = gamma(5) * (dot(absolute(p.normal), absolute(from)) + std::abs(p.offset));
+        double errorTo = gamma(5) * (dot(absolute(p.normal), absolute(to)) + std::abs(p.offset));
+        double span = std::abs(distanceFrom - distanceTo) * (1 - EPSILON);
+        if(span <= errorFrom + errorTo)
+        {
+            throw Degenerate("solid edge almost parallel to a cutter plane");
+        }
+        //the ends of the edge are exact, only their distances carry an error
+        double t = distanceFrom / (distanceFrom - distanceTo);
+        double tError = (errorFrom * std::abs(distanceTo) + errorTo * std::abs(distanceFrom))
+                        / (span * (span - errorFrom - errorTo)) + gamma(2) * std::abs(t);
+        Vec edge = to - from;
+        double edgeLength = length(edge);
+        double error = (tError * edgeLength + gamma(3) * (length(from) + std::abs(t) * edgeLength)) * (1 + gamma(4));
+        uint32_t point = addPoint(key, from + edge * t, error);
+        m_edgePoints[uint64_t(key.a) << 32 | key.b].push_back(point);
+        return point;
+    }
+
+    const Plane &Subtraction::trianglePlane(uint32_t triangle)
+    {
+        if(m_planeTriangle != triangle)
+        {
+            Vec a = m_points[m_solid.indices[triangle * 3]], b = m_points[m_solid.indices[triangle * 3 + 1]],
+                c = m_points[m_solid.indices[triangle * 3 + 2]];
+            Vec normal = cross(b - a, c - a), bound = crossBound(b - a, c - a) * gamma(4);
+            if(std::abs(normal.x) <= bound.x && std::abs(normal.y) <= bound.y && std::abs(normal.z) <= bound.z)
+            {
+                throw Degenerate("solid has a triangle without area");
+            }
+            normal = normal * (1 / length(normal));
+            m_trianglePlane = {normal, dot(normal, (a + b + c) * (1.0 / 3))};
+            //the plane is only approximate, but the triangle lies as close to it as its farthest vertex
+            m_trianglePlaneError = 0;
+            for(auto &&v : {a, b, c})
+            {
+                m_trianglePlaneError = std::max(m_trianglePlaneError, std::abs(m_trianglePlane.distance(v))
+                                                + gamma(5) * (dot(absolute(normal), absolute(v)) + std::abs(m_trianglePlane.offset)));
+            }
+            m_trianglePlaneError *= 1 + gamma(2);
+            m_planeTriangle = triangle;
+        }
+        return m_trianglePlane;
+    }
+
+    uint32_t Subtraction::linePoint(uint32_t triangle, uint32_t p, uint32_t q)
+    {
+        Key key{TRIANGLE_PLANES, triangle, std::min(p, q), std::max(p, q)};
+        auto found = m_keys.find(key);
+        if(found != m_keys.end())
+        {
+            return found->second;
+        }
+        double error;
+        const Plane &plane = trianglePlane(triangle);
+        Vec position = intersect(plane, m_planes[key.b], m_planes[key.c], error, m_trianglePlaneError);
+        uint32_t point = addPoint(key, position, error);
+        m_linePoints[uint64_t(triangle) << 32 | p].push_back(point);
+        m_linePoints[uint64_t(triangle) << 32 | q].push_back(point);
+        return point;
+    }
+
+    uint32_t Subtraction::cutterVertex(uint32_t p, uint32_t q, uint32_t r)
+    {
+        double error;
+        Vec position = intersect(m_planes[p], m_planes[q], m_planes[r], error);
+        for(auto &&point : m_cutterVertices)
+        {
+            Vec difference = m_points[point] - position;
+            if(dot(difference, difference) <= COPLANAR * COPLANAR * m_scale * m_scale)
+            {
+                //the vertex stands for all the planes merged into it
+                m_points.widen(point, (length(difference) + error) * (1 + gamma(2)));
+                return point;
+            }
+        }
+        m_cutterVertices.push_back(m_points.add(position, error));
+        return m_cutterVertices.back();
+    }
+
+    void Subtraction::buildPlanes()
+    {
+        //the orientation of the cutter triangles is not trusted
+        double orientation = m_cutter.volume() < 0 ? -1 : 1;
+        for(size_t t = 0; t < m_cutter.indices.size(); t += 3)
+        {
+            Vec a = vertex(m_cutter, m_cutter.indices[t]);
+            Vec b = vertex(m_cutter, m_cutter.indices[t + 1]);
+            Vec c = vertex(m_cutter, m_cutter.indices[t + 2]);
+            Vec normal = cross(b - a, c - a) * orientation;
+            double length = std::sqrt(dot(normal, normal));
+            if(length <= MIN_AREA * m_scale * m_scale)
+            {
+                continue;
+            }
+            normal = normal * (1 / length);
+            double offset = dot(normal, (a + b + c) * (1.0 / 3));
+            bool known = false;
+            for(auto &&plane : m_planes)
+            {
+                if(dot(plane.normal, normal) > 1 - COPLANAR && std::abs(plane.offset - offset) < COPLANAR * m_scale)
+                {
+                    known = true;
+                    break;
+                }
+            }
+            if(!known)
+            {
+                m_planes.push_back({normal, offset});
+            }
+        }
+        if(m_planes.size() < 4)
+        {
+            throw Degenerate("cutter is flat");
+        }
+        for(auto &&index : m_cutter.indices)
+        {
+            for(auto &&plane : m_planes)
+            {
+                if(plane.distance(vertex(m_cutter, index)) > COPLANAR * m_scale)
+                {
+                    throw Degenerate("cutter is not convex");
+                }
+            }
+        }
+    }
+
+    void Subtraction::buildFaces()
+    {
+        Vec cutterMin = vertex(m_cutter, m_cutter.indices[0]), cutterMax = cutterMin;
+        for(auto &&index : m_cutter.indices)
+        {
+            Vec v = vertex(m_cutter, index);
+            cutterMin = {std::min(cutterMin.x, v.x), std::min(cutterMin.y, v.y), std::min(cutterMin.z, v.z)};
+            cutterMax = {std::max(cutterMax.x, v.x), std::max(cutterMax.y, v.y), std::max(cutterMax.z, v.z)};
+        }
+        Vec center = (cutterMin + cutterMax) * 0.5;
+        double size = 4 * std::sqrt(dot(cutterMax - cutterMin, cutterMax - cutterMin));
+
+        m_faces.resize(m_planes.size());
+        for(uint32_t p = 0; p < m_planes.size(); p++)
+        {
+            const Plane &plane = m_planes[p];
+            Vec u = cross(plane.normal, std::abs(plane.normal.x) < 0.9 ? Vec{1, 0, 0} : Vec{0, 1, 0});
+            u = u * (1 / std::sqrt(dot(u, u)));
+            Vec v = cross(plane.normal, u);
+            Vec origin = center - plane.normal * plane.distance(center);
+
+            //a large square on the plane cut down by all other planes
+            std::vector<Vec> corners = {origin - (u + v) * size, origin + (u - v) * size, origin + (u + v) * size,
+                                        origin - (u - v) * size};
+            std::vector<uint32_t> edges(4, NONE);
+            for(uint32_t q = 0; q < m_planes.size() && !corners.empty(); q++)
+            {
+                if(q == p)
+                {
+                    continue;
+                }
+                std::vector<double> distances;
+                bool clipped = false;
+                for(auto &&corner : corners)
+                {
+                    distances.push_back(m_planes[q].distance(corner));
+                    clipped = clipped || distances.back() > 0;
+                }
+                if(!clipped)
+                {
+                    continue;
+                }
+                std::vector<Vec> inside;
+                std::vector<uint32_t> insideEdges;
+                for(size_t i = 0; i < corners.size(); i++)
+                {
+                    size_t j = (i + 1) % corners.size();
+                    if(distances[i] < 0)
+                    {
+                        inside.push_back(corners[i]);
+                        insideEdges.push_back(edges[i]);
+                    }
+                    if((distances[i] < 0) != (distances[j] < 0))
+                    {
+                        inside.push_back(corners[i] + (corners[j] - corners[i]) * (distances[i] / (distances[i] - distances[j])));
+                        insideEdges.push_back(distances[i] < 0 ? q : edges[i]);
+                    }
+                }
+                corners.swap(inside);
+                edges.swap(insideEdges);
+            }
+            if(corners.empty())
+            {
+                //the plane only touches the cutter, it does not bound it
+                continue;
+            }
+            Face &face = m_faces[p];
+            for(size_t i = 0; i < edges.size(); i++)
+            {
+                uint32_t previous = edges[(i + edges.size() - 1) % edges.size()];
+                if(edges[i] == NONE || previous == NONE)
+                {
+                    throw Degenerate("cutter is not closed");
+                }
+                face.points.push_back(cutterVertex(p, previous, edges[i]));
+                face.planes.push_back(edges[i]);
+            }
+            //edges of zero length are left where more than three planes meet
+            for(size_t i = 0; i < face.points.size() && face.points.size() > 1;)
+            {
+                size_t j = (i + 1) % face.points.size();
+                if(face.points[i] != face.points[j])
+                {
+                    i++;
+                    continue;
+                }
+                face.planes[i] = face.planes[j];
+                face.points.erase(face.points.begin() + j);
+                face.planes.erase(face.planes.begin() + j);
+                i = 0;
+            }
+            if(face.points.size() < 3)
+            {
+                face.points.clear();
+                face.planes.clear();
+            }
+        }
+
+        m_cutterMin = {INFINITY, INFINITY, INFINITY};
+        m_cutterMax = {-INFINITY, -INFINITY, -INFINITY};
+        for(auto &&face : m_faces)
+        {
+            for(auto &&point : face.points)
+            {
+                Vec v = m_points[point];
+                m_cutterMin = {std::min(m_cutterMin.x, v.x), std::min(m_cutterMin.y, v.y), std::min(m_cutterMin.z, v.z)};
+                m_cutterMax = {std::max(m_cutterMax.x, v.x), std::max(m_cutterMax.y, v.y), std::max(m_cutterMax.z, v.z)};
+                m_cutterError = std::max(m_cutterError, m_points.error(point));
+            }
+        }
+    }
+
+    bool Subtraction::nearCutter(uint32_t triangle) const
+    {
+        Vec low = {INFINITY, INFINITY, INFINITY}, high = {-INFINITY, -INFINITY, -INFINITY};
+        for(int j = 0; j < 3; j++)
+        {
+            Vec v = m_points[m_solid.indices[triangle * 3 + j]];
+            low = {std::min(low.x, v.x), std::min(low.y, v.y), std::min(low.z, v.z)};
+            high = {std::max(high.x, v.x), std::max(high.y, v.y), std::max(high.z, v.z)};
+        }
+        //the exact cutter vertices may lie outside of the box by their error, and the sums round
+        double margin = m_cutterError * (1 + gamma(2)) + gamma(2) * m_scale;
+        return low.x <= m_cutterMax.x + margin && high.x >= m_cutterMin.x - margin
+               && low.y <= m_cutterMax.y + margin && high.y >= m_cutterMin.y - margin
+               && low.z <= m_cutterMax.z + margin && high.z >= m_cutterMin.z - margin;
+    }
+
+    Along Subtraction::along(uint32_t from, uint32_t to, uint32_t point) const
+    {
+        Vec direction = m_points[to] - m_points[from], offset = m_points[point] - m_points[from];
+        double lineLength = length(direction), distance = length(offset);
+        //the errors of the ends turn the direction by at most this much
+        double turn = 2 * (m_points.error(from) + m_points.error(to)) / lineLength;
+        if(!(turn < 1))
+        {
+            throw Degenerate("distinct vertices at the same place");
+        }
+        Along result;
+        result.position = dot(offset, direction) / lineLength;
+        result.error = ((m_points.error(point) + m_points.error(from)) * (1 + turn) + distance * (turn + gamma(10))) * (1 + gamma(4));
+        result.point = point;
+        return result;
+    }
+
+    bool Subtraction::insideSolid(uint32_t point) const
+    {
+        //a ray along x from a point inside leaves the closed solid once more than it enters
+        Vec p = m_points[point];
+        double reach = m_points.error(point) * (1 + gamma(2)) + gamma(2) * m_scale;
+        Planar origin = {p.y, p.z, m_points.error(point)};
+        //only the triangles along the ray can cross it
+        double low[3] = {p.x - reach, p.y - reach, p.z - reach};
+        double high[3] = {std::max(m_solidMax.x, p.x), p.y + reach, p.z + reach};
+        std::vector<uint32_t> triangles;
+        m_index.query(low, high, triangles);
+        int crossings = 0;
+        for(auto &&triangle : triangles)
+        {
+            size_t t = triangle * size_t(3);
+            Vec a = m_points[m_solid.indices[t]], b = m_points[m_solid.indices[t + 1]], c = m_points[m_solid.indices[t + 2]];
+            if(std::max({a.x, b.x, c.x}) < p.x - reach || std::min({a.y, b.y, c.y}) > p.y + reach
+               || std::max({a.y, b.y, c.y}) < p.y - reach || std::min({a.z, b.z, c.z}) > p.z + reach
+               || std::max({a.z, b.z, c.z}) < p.z - reach)
+            {
+                continue;
+            }
+            Planar corners[3] = {{a.y, a.z, 0}, {b.y, b.z, 0}, {c.y, c.z, 0}};
+            double error;
+            double area = orient(corners[0], corners[1], corners[2], error);
+            int facing = sign(area, error);
+            if(facing == 0)
+            {
+                throw Degenerate("ray along a solid triangle");
+            }
+            bool missed = false, unknown = false;
+            for(int j = 0; j < 3; j++)
+            {
+                double edge = orient(corners[j], corners[(j + 1) % 3], origin, error);
+                missed = missed || sign(edge, error) == -facing;
+                unknown = unknown || sign(edge, error) == 0;
+            }
+            if(missed)
+            {
+                continue;
+            }
+            if(unknown)
+            {
+                throw Degenerate("ray through an edge of the solid");
+            }
+            //the triangle is ahead of the point when the point is behind its plane as seen along x
+            Vec ab = b - a, ac = c - a, ap = p - a, bound = crossBound(ab, ac);
+            double volume = dot(cross(ab, ac), ap);
+            double volumeError = (gamma(8) * dot(bound, absolute(ap)) + length(bound) * m_points.error(point)) * (1 + gamma(4));
+            int behind = sign(volume, volumeError);
+            if(behind == 0)
+            {
+                throw Degenerate("cutter vertex too close to the surface");
+            }
+            if(behind != facing)
+            {
+                crossings += facing;
+            }
+        }
+        return crossings > 0;
+    }
+
+    Polygon Subtraction::wholeTriangle(uint32_t triangle, bool inside) const
+    {
+        const uint32_t *v = &m_solid.indices[triangle * 3];
+        Polygon polygon(triangle, inside);
+        for(int j = 0; j < 3; j++)
+        {
+            uint32_t a = v[j], b = v[(j + 1) % 3];
+            polygon.add(a, Source{std::min(a, b), std::max(a, b)});
+        }
+        return polygon;
+    }
+
+    void Subtraction::clipTriangle(uint32_t triangle)
+    {
+        //Sutherland-Hodgman, only the part inside the cutter is kept
+        Polygon polygon(wholeTriangle(triangle, true));
+        bool clipped = false;
+        std::vector<char> sides;
+        for(uint32_t p = 0; p < m_planes.size(); p++)
+        {
+            if(m_faces[p].points.empty())
+            {
+                continue;
+            }
+            sides.clear();
+            size_t outsideCount = 0;
+            for(auto &&point : polygon.points)
+            {
+                sides.push_back(outside(point, p));
+                outsideCount += sides.back();
+            }
+            if(outsideCount == 0)
+            {
+                continue;
+            }
+            if(outsideCount == sides.size())
+            {
+                m_polygons.push_back(wholeTriangle(triangle, false));
+                return;
+            }
+            Polygon inside(triangle, true);
+            size_t n = polygon.points.size();
+            for(size_t i = 0; i < n; i++)
+            {
+                if(!sides[i])
+                {
+                    inside.add(polygon.points[i], polygon.sources[i]);
+                }
+                if(sides[i] != sides[(i + 1) % n])
+                {
+                    inside.add(crossing(triangle, polygon.sources[i], p), sides[i] ? polygon.sources[i] : Source{p, NONE});
+                }
+            }
+            polygon = std::move(inside);
+            clipped = true;
+        }
+        if(clipped)
+        {
+            splitOutside(polygon);
+        }
+        m_polygons.push_back(std::move(polygon));
+    }
+
+    void Subtraction::splitOutside(const Polygon &inside)
+    {
+        const uint32_t *v = &m_solid.indices[inside.triangle * 3];
+        auto triangleEdge = [v](Source source) {
+            for(int j = 0; j < 3; j++)
+            {
+                if(source.a == std::min(v[j], v[(j + 1) % 3]) && source.b == std::max(v[j], v[(j + 1) % 3]))
+                {
+                    return j;
+                }
+            }
+            return -1;
+        };
+        auto edgeSource = [v](int j) {
+            return Source{std::min(v[j], v[(j + 1) % 3]), std::max(v[j], v[(j + 1) % 3])};
+        };
+        const std::vector<uint32_t> &points = inside.points;
+        const std::vector<Source> &sources = inside.sources;
+        size_t n = points.size();
+
+        bool touches = false;
+        for(auto &&source : sources)
+        {
+            touches = touches || !source.onPlane();
+        }
+        if(!touches)
+        {
+            //the inside is a hole in the triangle, bridged from the first corner to a vertex the corner sees
+            size_t best = n;
+            double bestDistance = INFINITY;
+            for(size_t k = 0; k < n; k++)
+            {
+                Vec difference = m_points[points[k]] - m_points[v[0]];
+                double distance = dot(difference, difference);
+                if(distance < bestDistance
+                   && (outside(v[0], sources[(k + n - 1) % n].a) || outside(v[0], sources[k].a)))
+                {
+                    best = k;
+                    bestDistance = distance;
+                }
+            }
+            Polygon outsidePart(inside.triangle, false);
+            for(int j = 0; j < 3; j++)
+            {
+                outsidePart.add(v[j], edgeSource(j));
+            }
+            outsidePart.add(v[0], BRIDGE);
+            for(size_t m = 0; m < n; m++)
+            {
+                size_t k = (best + n - m) % n;
+                outsidePart.add(points[k], sources[(k + n - 1) % n]);
+            }
+            outsidePart.add(points[best], BRIDGE);
+            m_polygons.push_back(std::move(outsidePart));
+            return;
+        }
+
+        //every run of edges on cutter planes cuts off one part of the triangle
+        for(size_t i = 0; i < n; i++)
+        {
+            if(!sources[i].onPlane() || sources[(i + n - 1) % n].onPlane())
+            {
+                continue;
+            }
+            size_t e = i;
+            while(sources[e].onPlane())
+            {
+                e = (e + 1) % n;
+            }
+            int startEdge = triangleEdge(sources[(i + n - 1) % n]), endEdge = triangleEdge(sources[e]);
+            Polygon outsidePart(inside.triangle, false);
+            outsidePart.add(points[i], edgeSource(startEdge));
+            //both ends on one edge of the triangle, in order, leave no corner to go around
+            bool direct = false;
+            if(startEdge == endEdge)
+            {
+                Along start = along(v[startEdge], v[(startEdge + 1) % 3], points[i]),
+                      end = along(v[startEdge], v[(startEdge + 1) % 3], points[e]);
+                if(std::abs(end.position - start.position) <= start.error + end.error)
+                {
+                    throw Degenerate("distinct vertices at the same place");
+                }
+                direct = end.position > start.position;
+            }
+            for(int j = startEdge; !direct;)
+            {
+                j = (j + 1) % 3;
+                outsidePart.append(v[j], edgeSource(j));
+                direct = j == endEdge;
+            }
+            for(size_t k = e; k != i; k = (k + n - 1) % n)
+            {
+                outsidePart.append(points[k], sources[(k + n - 1) % n]);
+            }
+            m_polygons.push_back(std::move(outsidePart));
+        }
+    }
+
+    void Subtraction::traceSegments(uint32_t triangle)
+    {
+        const uint32_t *v = &m_solid.indices[triangle * 3];
+        for(uint32_t p = 0; p < m_planes.size(); p++)
+        {
+            if(m_faces[p].points.empty())
+            {
+                continue;
+            }
+            bool sides[3] = {outside(v[0], p), outside(v[1], p), outside(v[2], p)};
+            if(sides[0] == sides[1] && sides[1] == sides[2])
+            {
+                continue;
+            }
+            //the segment enters the inside of the plane where the triangle does and leaves where it does
+            uint32_t start = NONE, end = NONE;
+            for(int j = 0; j < 3; j++)
+            {
+                int k = (j + 1) % 3;
+                if(sides[j] && !sides[k])
+                {
+                    start = edgePoint(v[j], v[k], p);
+                }
+                else if(!sides[j] && sides[k])
+                {
+                    end = edgePoint(v[j], v[k], p);
+                }
+            }
+            uint32_t startPlane = NONE, endPlane = NONE;
+            bool dropped = false;
+            for(uint32_t q = 0; q < m_planes.size() && !dropped; q++)
+            {
+                if(q == p || m_faces[q].points.empty())
+                {
+                    continue;
+                }
+                bool startOutside = outside(start, q), endOutside = outside(end, q);
+                if(startOutside && endOutside)
+                {
+                    dropped = true;
+                }
+                else if(startOutside)
+                {
+                    start = linePoint(triangle, p, q);
+                    startPlane = q;
+                }
+                else if(endOutside)
+                {
+                    end = linePoint(triangle, p, q);
+                    endPlane = q;
+                }
+            }
+            if(dropped)
+            {
+                continue;
+            }
+            m_segments[p].push_back(std::make_pair(start, end));
+            if(startPlane != NONE)
+            {
+                m_crossings[p][startPlane].push_back(start);
+            }
+            if(endPlane != NONE)
+            {
+                m_crossings[p][endPlane].push_back(end);
+            }
+        }
+    }
+
+    void Subtraction::emit(const Polygon &polygon)
+    {
+        std::vector<uint32_t> &target = polygon.inside ? m_intersection : m_difference;
+        std::vector<uint32_t> ring;
+        bool split = false;
+        size_t n = polygon.points.size();
+        for(size_t i = 0; i < n; i++)
+        {
+            uint32_t a = polygon.points[i], b = polygon.points[(i + 1) % n];
+            ring.push_back(a);
+            const Source &source = polygon.sources[i];
+            if(source.bridge())
+            {
+                continue;
+            }
+            auto &points = source.onPlane() ? m_linePoints : m_edgePoints;
+            auto found = points.find(source.onPlane() ? uint64_t(polygon.triangle) << 32 | source.a
+                                                      : uint64_t(source.a) << 32 | source.b);
+            if(found == points.end())
+            {
+                continue;
+            }
+            Along end = along(a, b, b);
+            std::vector<Along> between;
+            for(auto &&point : found->second)
+            {
+                if(point == a || point == b || !m_used.count(point))
+                {
+                    continue;
+                }
+                Along position = along(a, b, point);
+                if(std::abs(position.position) <= position.error
+                   || std::abs(position.position - end.position) <= position.error + end.error)
+                {
+                    throw Degenerate("distinct vertices at the same place");
+                }
+                if(position.position > 0 && position.position < end.position)
+                {
+                    between.push_back(position);
+                }
+            }
+            std::sort(between.begin(), between.end());
+            for(size_t j = 0; j < between.size(); j++)
+            {
+                if(j > 0 && between[j].position - between[j - 1].position <= between[j].error + between[j - 1].error)
+                {
+                    throw Degenerate("distinct vertices at the same place");
+                }
+                ring.push_back(between[j].point);
+            }
+            split = split || !between.empty();
+        }
+
+        if(!polygon.inside && (split || n > 3))
+        {
+            const uint32_t *v = &m_solid.indices[polygon.triangle * 3];
+            clipEars(std::move(ring), cross(m_points[v[1]] - m_points[v[0]], m_points[v[2]] - m_points[v[0]]), target,
+                     nullptr);
+            return;
+        }
+        if(!split)
+        {
+            for(size_t i = 1; i + 1 < ring.size(); i++)
+            {
+                target.insert(target.end(), {ring[0], ring[i], ring[i + 1]});
+            }
+            return;
+        }
+        //the polygon is convex, a fan from its centroid has no degenerate triangles
+        Vec center = {0, 0, 0};
+        double error = 0;
+        for(auto &&point : ring)
+        {
+            center = center + m_points[point];
+            error = std::max(error, m_points.error(point));
+        }
+        uint32_t middle = m_points.add(center * (1.0 / ring.size()), error + gamma(static_cast<int>(ring.size()) + 1) * m_scale);
+        for(size_t i = 0; i < ring.size(); i++)
+        {
+            target.insert(target.end(), {middle, ring[i], ring[(i + 1) % ring.size()]});
+        }
+    }
+
+    void Subtraction::classifyCutterVertices()
+    {
+        //crossings along a cutter edge flip between inside and outside, so one vertex decides the rest
+        struct Edge
+        {
+            uint32_t from, to;
+            bool flips;
+        };
+        std::vector<Edge> edges;
+        for(uint32_t p = 0; p < m_faces.size(); p++)
+        {
+            const Face &face = m_faces[p];
+            for(size_t i = 0; i < face.points.size(); i++)
+            {
+                auto crossings = m_crossings[p].find(face.planes[i]);
+                bool flips = crossings != m_crossings[p].end() && crossings->second.size() % 2 == 1;
+                edges.push_back({face.points[i], face.points[(i + 1) % face.points.size()], flips});
+            }
+        }
+
+        uint32_t seed = edges[0].from;
+        bool seedInside = true;
+        for(auto &&edge : edges)
+        {
+            Vec v = m_points[edge.from];
+            double reach = m_points.error(edge.from) * (1 + gamma(2)) + gamma(2) * m_scale;
+            if(v.x < m_solidMin.x - reach || v.y < m_solidMin.y - reach || v.z < m_solidMin.z - reach
+               || v.x > m_solidMax.x + reach || v.y > m_solidMax.y + reach || v.z > m_solidMax.z + reach)
+            {
+                seed = edge.from;
+                seedInside = false;
+                break;
+            }
+        }
+        if(seedInside)
+        {
+            seedInside = insideSolid(seed);
+        }
+
+        m_cutterInside[seed] = seedInside;
+        bool changed = true;
+        while(changed)
+        {
+            changed = false;
+            for(auto &&edge : edges)
+            {
+                auto from = m_cutterInside.find(edge.from), to = m_cutterInside.find(edge.to);
+                if(from != m_cutterInside.end() && to == m_cutterInside.end())
+                {
+                    m_cutterInside[edge.to] = from->second != edge.flips;
+                    changed = true;
+                }
+                else if(from == m_cutterInside.end() && to != m_cutterInside.end())
+                {
+                    m_cutterInside[edge.from] = to->second != edge.flips;
+                    changed = true;
+                }
+                else if(from != m_cutterInside.end() && (from->second != edge.flips) != to->second)
+                {
+                    throw Degenerate("inconsistent crossings of a cutter edge");
+                }
+            }
+        }
+    }
+
+    void Subtraction::closeFace(uint32_t plane)
+    {
+        const Face &face = m_faces[plane];
+        std::vector<std::pair<uint32_t, uint32_t>> segments(m_segments[plane]);
+        size_t used = 0;
+        for(size_t i = 0; i < face.points.size(); i++)
+        {
+            uint32_t from = face.points[i], to = face.points[(i + 1) % face.points.size()];
+            std::vector<Along> positions;
+            auto crossings = m_crossings[plane].find(face.planes[i]);
+            if(crossings != m_crossings[plane].end())
+            {
+                for(auto &&point : crossings->second)
+                {
+                    positions.push_back(along(from, to, point));
+                }
+                std::sort(positions.begin(), positions.end());
+                for(size_t j = 1; j < positions.size(); j++)
+                {
+                    if(positions[j].position - positions[j - 1].position <= positions[j].error + positions[j - 1].error)
+                    {
+                        throw Degenerate("cutter edge crosses the surface twice at one place");
+                    }
+                }
+                used += positions.size();
+            }
+
+            //the parts of the edge inside the solid bound the face from outside
+            bool inside = m_cutterInside.at(from);
+            uint32_t current = from;
+            for(auto &&crossing : positions)
+            {
+                if(inside)
+                {
+                    segments.push_back(std::make_pair(current, crossing.point));
+                }
+                inside = !inside;
+                current = crossing.point;
+            }
+            if(inside)
+            {
+                segments.push_back(std::make_pair(current, to));
+            }
+            if(inside != m_cutterInside.at(to))
+            {
+                throw Degenerate("inconsistent crossings of a cutter edge");
+            }
+        }
+        size_t crossingCount = 0;
+        for(auto &&crossings : m_crossings[plane])
+        {
+            crossingCount += crossings.second.size();
+        }
+        if(used != crossingCount)
+        {
+            throw Degenerate("surface leaves a cutter face through a vertex");
+        }
+        if(segments.empty())
+        {
+            return;
+        }
+
+        std::unordered_map<uint32_t, uint32_t> next;
+        for(auto &&segment : segments)
+        {
+            if(!next.emplace(segment.first, segment.second).second)
+            {
+                throw Degenerate("boundary of a cutter face touches itself");
+            }
+        }
+        std::vector<std::vector<uint32_t>> loops;
+        std::unordered_set<uint32_t> visited;
+        for(auto &&segment : segments)
+        {
+            if(visited.count(segment.first))
+            {
+                continue;
+            }
+            std::vector<uint32_t> loop;
+            uint32_t point = segment.first;
+            do
+            {
+                if(!visited.insert(point).second)
+                {
+                    throw Degenerate("boundary of a cutter face touches itself");
+                }
+                loop.push_back(point);
+                auto found = next.find(point);
+                if(found == next.end())
+                {
+                    throw Degenerate("boundary of a cutter face is open");
+                }
+                point = found->second;
+            }
+            while(point != segment.first);
+            loops.push_back(std::move(loop));
+        }
+        triangulate(plane, std::move(loops));
+    }
+
+    void Subtraction::triangulate(uint32_t plane, std::vector<std::vector<uint32_t>> loops)
+    {
+        const Vec &normal = m_planes[plane].normal;
+        Projection projection(m_points, normal);
+        auto x = [&](uint32_t point) { return projection.x(point); };
+        auto y = [&](uint32_t point) { return projection.y(point); };
+
+        //counter-clockwise loops bound the region from outside, clockwise ones are holes
+        std::vector<std::vector<uint32_t>> outers, holes;
+        std::vector<double> outerAreas;
+        for(auto &&loop : loops)
+        {
+            //a fan from the first point, the sum rounds once more for every term
+            double area = 0, areaError = 0, magnitude = 0;
+            for(size_t i = 1; i + 1 < loop.size(); i++)
+            {
+                double error;
+                double term = projection.orient(loop[0], loop[i], loop[i + 1], error);
+                area += term;
+                areaError += error;
+                magnitude += std::abs(term);
+            }
+            areaError = (areaError + gamma(static_cast<int>(loop.size())) * magnitude) * (1 + gamma(4));
+            if(std::abs(area) <= areaError)
+            {
+                throw Degenerate("cutter face region without area");
+            }
+            if(area > 0)
+            {
+                outers.push_back(std::move(loop));
+                outerAreas.push_back(area);
+            }
+            else
+            {
+                holes.push_back(std::move(loop));
+            }
+        }
+
+        //even-odd rule along a ray in the direction of x, the edge is on the ray when the point is left of it going up
+        auto above = [&](uint32_t a, uint32_t point) {
+            Planar from = projection.planar(a), to = projection.planar(point);
+            int result = sign(from.y - to.y, (from.error + to.error + EPSILON * std::abs(from.y - to.y)) * (1 + gamma(2)));
+            if(result == 0)
+            {
+                throw Degenerate("cutter face vertices at the same height");
+            }
+            return result > 0;
+        };
+        auto contains = [&](const std::vector<uint32_t> &loop, uint32_t point) {
+            bool inside = false;
+            for(size_t i = 0, j = loop.size() - 1; i < loop.size(); j = i++)
+            {
+                bool up = above(loop[i], point);
+                if(up == above(loop[j], point))
+                {
+                    continue;
+                }
+                int left = projection.side(loop[j], loop[i], point);
+                if(left == 0)
+                {
+                    throw Degenerate("hole touches the cutter face region");
+                }
+                if((left > 0) == up)
+                {
+                    inside = !inside;
+                }
+            }
+            return inside;
+        };
+        //segments on one line only miss each other when their extents are certainly apart
+        auto apart = [&](uint32_t a, uint32_t b, uint32_t c, uint32_t d) {
+            Planar p[4] = {projection.planar(a), projection.planar(b), projection.planar(c), projection.planar(d)};
+            for(auto &&coordinate : {&Planar::x, &Planar::y})
+            {
+                double low[2], high[2], error[2];
+                for(int k = 0; k < 2; k++)
+                {
+                    low[k] = std::min(p[2 * k].*coordinate, p[2 * k + 1].*coordinate);
+                    high[k] = std::max(p[2 * k].*coordinate, p[2 * k + 1].*coordinate);
+                    error[k] = std::max(p[2 * k].error, p[2 * k + 1].error);
+                }
+                double gap = std::max(low[1] - high[0], low[0] - high[1]);
+                if(gap > (error[0] + error[1] + EPSILON * std::abs(gap)) * (1 + gamma(2)))
+                {
+                    return true;
+                }
+            }
+            return false;
+        };
+        //a side that is not certain blocks the bridge unless it cannot matter
+        auto crosses = [&](uint32_t a, uint32_t b, uint32_t c, uint32_t d) {
+            if(a == c || a == d || b == c || b == d)
+            {
+                return false;
+            }
+            int sides[4] = {projection.side(a, b, c), projection.side(a, b, d), projection.side(c, d, a), projection.side(c, d, b)};
+            if((sides[0] && sides[0] == sides[1]) || (sides[2] && sides[2] == sides[3]))
+            {
+                return false;
+            }
+            if(sides[0] && sides[1] && sides[2] && sides[3])
+            {
+                return true;
+            }
+            return !apart(a, b, c, d);
+        };
+
+        //every hole is joined to the smallest loop around it by a bridge that crosses no edge
+        for(auto &&hole : holes)
+        {
+            size_t owner = outers.size();
+            for(size_t i = 0; i < outers.size(); i++)
+            {
+                if(contains(outers[i], hole[0]) && (owner == outers.size() || outerAreas[i] < outerAreas[owner]))
+                {
+                    owner = i;
+                }
+            }
+            if(owner == outers.size())
+            {
+                throw Degenerate("hole outside of the cutter face region");
+            }
+            std::vector<uint32_t> &outer = outers[owner];
+            size_t holeStart = 0;
+            for(size_t i = 1; i < hole.size(); i++)
+            {
+                if(x(hole[i]) > x(hole[holeStart]))
+                {
+                    holeStart = i;
+                }
+            }
+            uint32_t from = hole[holeStart];
+            size_t best = outer.size();
+            double bestDistance = INFINITY;
+            for(size_t i = 0; i < outer.size(); i++)
+            {
+                double dx = x(outer[i]) - x(from), dy = y(outer[i]) - y(from);
+                double distance = dx * dx + dy * dy;
+                if(distance >= bestDistance)
+                {
+                    continue;
+                }
+                bool blocked = false;
+                for(auto &&loop : {&outer, &hole})
+                {
+                    for(size_t j = 0; j < loop->size() && !blocked; j++)
+                    {
+                        blocked = crosses(from, outer[i], (*loop)[j], (*loop)[(j + 1) % loop->size()]);
+                    }
+                }
+                for(auto &&other : holes)
+                {
+                    for(size_t j = 0; j < other.size() && !blocked; j++)
+                    {
+                        blocked = crosses(from, outer[i], other[j], other[(j + 1) % other.size()]);
+                    }
+                }
+                if(!blocked)
+                {
+                    best = i;
+                    bestDistance = distance;
+                }
+            }
+            if(best == outer.size())
+            {
+                throw Degenerate("hole in a cutter face could not be bridged");
+            }
+            std::vector<uint32_t> joined(outer.begin(), outer.begin() + best + 1);
+            for(size_t i = 0; i <= hole.size(); i++)
+            {
+                joined.push_back(hole[(holeStart + i) % hole.size()]);
+            }
+            joined.insert(joined.end(), outer.begin() + best, outer.end());
+            outer.swap(joined);
+        }
+
+        for(auto &&ring : outers)
+        {
+            clipEars(std::move(ring), normal, m_intersection, &m_difference);
+        }
+    }
+
+    void Subtraction::clipEars(std::vector<uint32_t> ring, Vec normal, std::vector<uint32_t> &target,
+                               std::vector<uint32_t> *reversed)
+    {
+        Projection projection(m_points, normal);
+        //the point is certainly on the right of the line from a to b
+        auto outside = [&](uint32_t a, uint32_t b, uint32_t point) { return projection.side(a, b, point) < 0; };
+        auto convex = [&](uint32_t a, uint32_t b, uint32_t c) { return outside(a, c, b); };
+
+        //a vertex inside the ear or near its edges blocks it, so no triangle overlaps another
+        size_t i = 0, failures = 0;
+        while(ring.size() > 3)
+        {
+            if(failures > ring.size())
+            {
+                throw Degenerate("polygon could not be triangulated");
+            }
+            size_t n = ring.size();
+            uint32_t a = ring[(i + n - 1) % n], b = ring[i % n], c = ring[(i + 1) % n];
+            bool ear = convex(a, b, c);
+            for(size_t j = 0; j < n && ear; j++)
+            {
+                uint32_t point = ring[j];
+                if(point == a || point == b || point == c)
+                {
+                    continue;
+                }
+                ear = outside(a, b, point) || outside(b, c, point) || outside(c, a, point);
+            }
+            if(!ear)
+            {
+                i = (i + 1) % n;
+                failures++;
+                continue;
+            }
+            target.insert(target.end(), {a, b, c});
+            if(reversed)
+            {
+                reversed->insert(reversed->end(), {a, c, b});
+            }
+            ring.erase(ring.begin() + i % n);
+            i = (i + n - 2) % (n - 1);
+            failures = 0;
+        }
+        if(!convex(ring[0], ring[1], ring[2]))
+        {
+            throw Degenerate("polygon could not be triangulated");
+        }
+        target.insert(target.end(), {ring[0], ring[1], ring[2]});
+        if(reversed)
+        {
+            reversed->insert(reversed->end(), {ring[0], ring[2], ring[1]});
+        }
+    }
+
+    void Subtraction::checkPatch(const std::vector<uint32_t> &replaced) const
+    {
+        auto key = [](uint64_t from, uint64_t to) { return from << 32 | to; };
+        std::unordered_set<uint64_t> oldEdges, newEdges;
+        oldEdges.reserve(replaced.size() * 3);
+        for(auto &&t : replaced)
+        {
+            const uint32_t *v = &m_solid.indices[t * 3];
+            for(int j = 0; j < 3; j++)
+            {
+                oldEdges.insert(key(v[j], v[(j + 1) % 3]));
+            }
+        }
+        newEdges.reserve(m_difference.size());
+        uint32_t solidVertices = static_cast<uint32_t>(m_solid.vertexCount());
+        for(size_t t = 0; t < m_difference.size(); t += 3)
+        {
+            for(int j = 0; j < 3; j++)
+            {
+                uint32_t from = m_difference[t + j], to = m_difference[t + (j + 1) % 3];
+                //an edge between two old vertices that was not replaced is still used by a kept triangle
+                if(from == to || !newEdges.insert(key(from, to)).second
+                   || (from < solidVertices && to < solidVertices && oldEdges.count(key(from, to)) == 0))
+                {
+                    throw Degenerate("result is not closed");
+                }
+            }
+        }
+        //the kept triangles meet the patch along its boundary, exactly there the new triangles may stay open
+        auto boundary = [&](uint64_t edge) { return oldEdges.count(edge) && !oldEdges.count(edge >> 32 | edge << 32); };
+        for(auto &&edge : newEdges)
+        {
+            if(!newEdges.count(edge >> 32 | edge << 32) && !boundary(edge))
+            {
+                throw Degenerate("result is not closed");
+            }
+        }
+        for(auto &&edge : oldEdges)
+        {
+            if(boundary(edge) && !newEdges.count(edge))
+            {
+                throw Degenerate("result is not closed");
+            }
+        }
+    }
+
+    gg::MTriangleMesh Subtraction::collect(const std::vector<uint32_t> &triangles) const
+    {
+        gg::MTriangleMesh mesh;
+        std::unordered_map<uint32_t, uint32_t> remap;
+        mesh.indices.reserve(triangles.size());
+        for(auto &&point : triangles)
+        {
+            auto inserted = remap.emplace(point, static_cast<uint32_t>(mesh.vertexCount()));
+            if(inserted.second)
+            {
+                Vec v = m_points[point];
+                mesh.vertices.insert(mesh.vertices.end(), {v.x, v.y, v.z});
+            }
+            mesh.indices.push_back(inserted.first->second);
+        }
+        return mesh;
+    }
+
+    gg::MTriangleMesh Subtraction::run()
+    {
+        if(m_cutter.empty() || m_solid.empty())
+        {
+            return gg::MTriangleMesh();
+        }
+        //the box of the index does not shrink with the solid, the bounds derived from it are only a little looser
+        m_solidMin = {m_index.low()[0], m_index.low()[1], m_index.low()[2]};
+        m_solidMax = {m_index.high()[0], m_index.high()[1], m_index.high()[2]};
+        for(auto &&coordinate : {m_solidMin.x, m_solidMin.y, m_solidMin.z, m_solidMax.x, m_solidMax.y, m_solidMax.z})
+        {
+            m_scale = std::max(m_scale, std::abs(coordinate));
+        }
+        for(auto &&coordinate : m_cutter.vertices)
+        {
+            m_scale = std::max(m_scale, std::abs(coordinate));
+        }
+        m_scale = std::max(m_scale, 1e-6);
+
+        buildPlanes();
+        buildFaces();
+
+        //only the patch of triangles around the cutter is cut, the index yields every triangle nearCutter can accept
+        m_segments.resize(m_planes.size());
+        m_crossings.resize(m_planes.size());
+        double margin = m_cutterError * (1 + gamma(2)) + gamma(2) * m_scale;
+        double low[3] = {m_cutterMin.x - margin, m_cutterMin.y - margin, m_cutterMin.z - margin};
+        double high[3] = {m_cutterMax.x + margin, m_cutterMax.y + margin, m_cutterMax.z + margin};
+        std::vector<uint32_t> candidates;
+        m_index.query(low, high, candidates);
+        for(auto &&t : candidates)
+        {
+            if(nearCutter(t))
+            {
+                m_replaced.push_back(t);
+                traceSegments(t);
+                clipTriangle(t);
+            }
+        }
+        for(auto &&polygon : m_polygons)
+        {
+            m_used.insert(polygon.points.begin(), polygon.points.end());
+        }
+        for(auto &&polygon : m_polygons)
+        {
+            emit(polygon);
+        }
+        //every point of a polygon lies in the box of the cutter, so a far triangle hardly ever shares a split edge;
+        //the far triangles are only looked up when an edge with a used point is not shared by two patch triangles
+        std::unordered_map<uint64_t, int> patchEdges;
+        for(auto &&t : m_replaced)
+        {
+            const uint32_t *v = &m_solid.indices[t * 3];
+            for(int j = 0; j < 3; j++)
+            {
+                patchEdges[uint64_t(std::min(v[j], v[(j + 1) % 3])) << 32 | std::max(v[j], v[(j + 1) % 3])]++;
+            }
+        }
+        std::unordered_set<uint64_t> splitEdges;
+        for(auto &&edge : m_edgePoints)
+        {
+            auto shared = patchEdges.find(edge.first);
+            if(shared != patchEdges.end() && shared->second > 1)
+            {
+                continue;
+            }
+            for(auto &&point : edge.second)
+            {
+                if(m_used.count(point))
+                {
+                    splitEdges.insert(edge.first);
+                }
+            }
+        }
+        //a far triangle on a split edge has both ends of the edge as corners, so its box reaches the box of the edge
+        std::unordered_set<uint32_t> patch(m_replaced.begin(), m_replaced.end());
+        std::vector<uint32_t> far;
+        for(auto &&edge : splitEdges)
+        {
+            Vec a = m_points[static_cast<uint32_t>(edge >> 32)], b = m_points[static_cast<uint32_t>(edge)];
+            double edgeLow[3] = {std::min(a.x, b.x), std::min(a.y, b.y), std::min(a.z, b.z)};
+            double edgeHigh[3] = {std::max(a.x, b.x), std::max(a.y, b.y), std::max(a.z, b.z)};
+            m_index.query(edgeLow, edgeHigh, candidates);
+            for(auto &&t : candidates)
+            {
+                if(!patch.count(t))
+                {
+                    far.push_back(t);
+                }
+            }
+        }
+        std::sort(far.begin(), far.end());
+        far.erase(std::unique(far.begin(), far.end()), far.end());
+        for(auto &&t : far)
+        {
+            const uint32_t *v = &m_solid.indices[t * 3];
+            bool split = false;
+            for(int j = 0; j < 3 && !split; j++)
+            {
+                split = splitEdges.count(uint64_t(std::min(v[j], v[(j + 1) % 3])) << 32 | std::max(v[j], v[(j + 1) % 3])) > 0;
+            }
+            if(split)
+            {
+                m_replaced.push_back(t);
+                emit(wholeTriangle(t, false));
+            }
+        }
+        //a cutter that no triangle reaches is either outside or makes a cavity, the winding number tells which
+        classifyCutterVertices();
+        for(uint32_t p = 0; p < m_planes.size(); p++)
+        {
+            if(!m_faces[p].points.empty())
+            {
+                closeFace(p);
+            }
+        }
+        checkPatch(m_replaced);
+        gg::MTriangleMesh intersection(collect(m_intersection));
+        if(!intersection.empty() && !intersection.isClosed())
+        {
+            throw Degenerate("result is not closed");
+        }
+        return intersection;
+    }
+
+    void Subtraction::splice(gg::MTriangleMesh &solid, gg::MTriangleIndex &index) const
+    {
+        for(auto &&t : m_replaced)
+        {
+            index.remove(solid, t);
+        }
+        //the constructed points are appended to the vertices, the vertices of the replaced triangles stay unused
+        std::unordered_map<uint32_t, uint32_t> remap;
+        std::vector<uint32_t> triangles(m_difference);
+        for(auto &&point : triangles)
+        {
+            if(point >= m_points.solidCount())
+            {
+                auto inserted = remap.emplace(point, static_cast<uint32_t>(solid.vertexCount()));
+                if(inserted.second)
+                {
+                    Vec v = m_points[point];
+                    solid.vertices.insert(solid.vertices.end(), {v.x, v.y, v.z});
+                }
+                point = inserted.first->second;
+            }
+        }
+        //the new triangles take the slots of the replaced ones, those over their number are appended
+        std::vector<uint32_t> slots(m_replaced);
+        std::sort(slots.begin(), slots.end());
+        size_t count = triangles.size() / 3;
+        for(size_t i = 0; i < count; i++)
+        {
+            if(i < slots.size())
+            {
+                std::copy(&triangles[i * 3], &triangles[i * 3] + 3, &solid.indices[slots[i] * 3]);
+                index.insert(solid, slots[i]);
+            }
+            else
+            {
+                solid.indices.insert(solid.indices.end(), &triangles[i * 3], &triangles[i * 3] + 3);
+                index.insert(solid, static_cast<uint32_t>(solid.triangleCount() - 1));
+            }
+        }
+        //slots left over are filled with the last triangles, from the back, so that no triangle moves twice
+        for(size_t i = slots.size(); i-- > count;)
+        {
+            uint32_t last = static_cast<uint32_t>(solid.triangleCount() - 1);
+            if(slots[i] != last)
+            {
+                index.remove(solid, last);
+                std::copy(&solid.indices[last * 3], &solid.indices[last * 3] + 3, &solid.indices[slots[i] * 3]);
+                index.insert(solid, slots[i]);
+            }
+            solid.indices.resize(solid.indices.size() - 3);
+        }
+    }
+}
+
+gg::MTriangleMesh gg::MFastBoolean::subtract(MTriangleMesh &solid, MTriangleIndex &index, const MTriangleMesh &cutter)
+{
+    Subtraction subtraction(solid, index, cutter);
+    MTriangleMesh inside(subtraction.run());
+    subtraction.splice(solid, index);
+    return inside;
+}
+
+gg::MTriangleMesh gg::MFastBoolean::intersect(const MTriangleMesh &solid, const MTriangleIndex &index,
+                                              const MTriangleMesh &cutter)
+{
+    Subtraction subtraction(solid, index, cutter);
+    return subtraction.run();
+}
+
+std::tuple<gg::MTriangleMesh, gg::MTriangleMesh> gg::MFastBoolean::subtract(const MTriangleMesh &solid,
+                                                                            const MTriangleMesh &cutter)
+{
+    MTriangleMesh rest(solid);
+    MTriangleIndex index(rest);
+    MTriangleMesh inside(subtract(rest, index, cutter));
+    return std::make_tuple(std::move(rest), std::move(inside));
+}
+
+std::tuple<gg::MTriangleMesh, std::vector<gg::MTriangleMesh>> gg::MFastBoolean::subtract(const MTriangleMesh &solid,
+                                                                                        const std::vector<MTriangleMesh> &cutters)
+{
+    MTriangleMesh rest(solid);
+    MTriangleIndex index(rest);
+    std::vector<MTriangleMesh> debris;
+    for(auto &&cutter : cutters)
+    {
+        MTriangleMesh inside(subtract(rest, index, cutter));
+        if(!inside.empty())
+        {
+            debris.push_back(std::move(inside));
+        }
+    }
+    return std::make_tuple(std::move(rest), std::move(debris));
+}
@@ -0,0 +1,60 @@
+/*
+ * boolean operations on indexed triangle meshes in floating-point arithmetic.
+ * The solid is clipped triangle by triangle against the planes of a convex cutter,
+ * then the faces of the cutter lying inside the solid are added to close both parts.
+ * Only the patch of triangles whose boxes reach the cutter is cut and validated: the patch is found through
+ * a spatial index of the triangles kept with the solid and the new triangles are spliced into the arrays of
+ * the solid in its place, so the cost of a cut follows the complexity around the cutter, not the size of the solid.
+ * Signs are decided in double arithmetic with static error bounds: every constructed vertex
+ * carries a bound on its distance from the exact point it stands for, and a plane-side or
+ * orientation test throws Degenerate when its value lies within the bound derived from the
+ * magnitudes of its operands, so every sign that is accepted is the exact one. The planes of
+ * the cutter, as computed from its float vertices, are taken as its exact definition.
+ * A result that is not a closed mesh throws as well, so that the caller can repeat the
+ * operation exactly on Nef polyhedra.
+ * New vertices are named after the primitives they were constructed from,
+ * which lets neighbouring triangles share them without any welding.
+ */
+
+#ifndef FASTBOOLEAN_H
+#define FASTBOOLEAN_H
+
+#include "TriangleIndex.h"
+#include "TriangleMesh.h"
+
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+namespace gg
+{
+
+    class MFastBoolean
+    {
+    public:
+        class Degenerate : public std::runtime_error
+        {
+        public:
+            explicit Degenerate(const char *what) : std::runtime_error(what)
+            {}
+        };
+
+        //cuts the convex cutter out of the solid in place and returns the part of the solid inside it, both closed;
+        //the patch replaces its triangles in the solid and in the index, the vertices it no longer uses are left
+        //where they are. The solid and the index stay as they were when Degenerate is thrown
+        static MTriangleMesh subtract(MTriangleMesh &solid, MTriangleIndex &index, const MTriangleMesh &cutter);
+
+        //the part of the solid inside the convex cutter, closed
+        static MTriangleMesh intersect(const MTriangleMesh &solid, const MTriangleIndex &index, const MTriangleMesh &cutter);
+
+        //the solid without the convex cutter and the part of the solid inside it, on a copy of the solid indexed first
+        static std::tuple<MTriangleMesh, MTriangleMesh> subtract(const MTriangleMesh &solid, const MTriangleMesh &cutter);
+
+        //cutters are subtracted one after another, the part cut off by each of them is returned separately
+        static std::tuple<MTriangleMesh, std::vector<MTriangleMesh>> subtract(const MTriangleMesh &solid,
+                                                                             const std::vector<MTriangleMesh> &cutters);
+    };
+
+}
+
+#endif // FASTBOOLEAN_H
@@ -9,13 +9,21 @@ using namespace video;
 using namespace io;
 using namespace gui;
 
-gg::MGame::MGame()
+gg::MGame::MGame(const MSettings &settings) : m_settings(settings)
 {
     m_events = new MEventReceiver();
     m_done = false;
     m_velocity = -60;
 
-    m_irrDevice.reset(createDevice(video::EDT_OPENGL, dimension2d<u32>(1920, 1080), 32, false, false, false, m_events));
+    if(m_settings.headless)
+    {
+        //no window and no rendering, only the scene graph is kept for the simulation
+        m_irrDevice.reset(createDevice(video::EDT_NULL, dimension2d<u32>(1920, 1080), 32, false, false, false, 0));
+    }
+    else
+    {
+        m_irrDevice.reset(createDevice(video::EDT_OPENGL, dimension2d<u32>(1920, 1080), 32, false, false, false, m_events));
+    }
     m_irrGUI = m_irrDevice->getGUIEnvironment();
     m_irrTimer = m_irrDevice->getTimer();
     m_irrScene = m_irrDevice->getSceneManager();
@@ -28,7 +36,8 @@ gg::MGame::MGame()
     m_btWorld = new btDiscreteDynamicsWorld(m_dispatcher, m_broadPhase, m_solver, m_collisionConfiguration);
 
     m_objectCreator.reset(new MObjectCreator(m_irrDevice.get()));
-    m_resolver = std::make_unique<MCollisionResolver>(m_irrDevice.get(), m_btWorld, m_objectCreator.get(), &m_objects);
+    m_resolver = std::make_unique<MCollisionResolver>(m_irrDevice.get(), m_btWorld, m_objectCreator.get(), &m_objects,
+                                                      m_settings);
 }
 
 gg::MGame::~MGame()
@@ -41,20 +50,26 @@ gg::MGame::~MGame()
 
 }
 
-void gg::MGame::run(bool debug)
+void gg::MGame::run()
 {
+    MTrace::nameThread("main");
+    if(!m_settings.headless)
+    {
+        runInteractive();
+        return;
+    }
 
-    ITexture *images = m_irrDriver->getTexture("media/loading.jpg");
-    m_irrDevice->getCursorControl()->setVisible(0);
-    m_irrDevice->setWindowCaption(L"Simulation of environment destruction");
-    m_irrDriver->beginScene(true, true, SColor(255, 20, 0, 0));
-    m_irrScene->drawAll();
-    m_irrDriver->draw2DImage(images, core::position2d<s32>(0, 0), core::rect<s32>(0, 0, 1920, 1080), 0,
-                             video::SColor(255, 255, 255, 255), false);
-    m_irrDriver->endScene();
+    MScript script;
+    if(script.load(m_settings.script))
+    {
+        runHeadless(script);
+    }
+}
 
+void gg::MGame::loadWorld(std::string level)
+{
     MLoader loader(m_irrDevice.get());
-    m_objects = loader.load("media/world.cfg");
+    m_objects = loader.load(level);
     for(size_t i = 0; i < m_objects.size(); i++)
     {
         //ship
@@ -70,6 +85,24 @@ void gg::MGame::run(bool debug)
         m_objects[i]->getRigid()->activate();
     }
 
+    m_btWorld->setGravity(btVector3(0, -9, 0));
+    m_btShip->setGravity(btVector3(0, 0, 0));
+    createStartScene();
+}
+
+void gg::MGame::runInteractive()
+{
+    ITexture *images = m_irrDriver->getTexture("media/loading.jpg");
+    m_irrDevice->getCursorControl()->setVisible(0);
+    m_irrDevice->setWindowCaption(L"Simulation of environment destruction");
+    m_irrDriver->beginScene(true, true, SColor(255, 20, 0, 0));
+    m_irrScene->drawAll();
+    m_irrDriver->draw2DImage(images, core::position2d<s32>(0, 0), core::rect<s32>(0, 0, 1920, 1080), 0,
+                             video::SColor(255, 255, 255, 255), false);
+    m_irrDriver->endScene();
+
+    loadWorld("media/world.cfg");
+
 
     MDebugDraw debugDraw(m_irrDevice.get());
     debugDraw.setDebugMode(
@@ -79,11 +112,7 @@ void gg::MGame::run(bool debug)
     m_btWorld->setDebugDrawer(&debugDraw);
     irr::video::SMaterial debugMat;
     debugMat.Lighting = false;
-    const bool debug_draw_bullet = debug;
-
-    m_btWorld->setGravity(btVector3(0, -9, 0));
-    m_btShip->setGravity(btVector3(0, 0, 0));
-    createStartScene();
+    const bool debug_draw_bullet = m_settings.debug;
 
     m_irrScene->getGUIEnvironment()->addStaticText(L"FPS:", rect<s32>(35, 35, 50, 50), false, false, 0);
     IGUIStaticText *fpsTextElement = m_irrScene->getGUIEnvironment()->addStaticText(L"", rect<s32>(50, 35, 180, 50),
@@ -129,6 +158,36 @@ void gg::MGame::run(bool debug)
 
 }
 
+void gg::MGame::runHeadless(const MScript &script)
+{
+    loadWorld(script.getWorld());
+
+    Timer wall;
+    for(u32 frame = 0; frame < script.getFrames(); frame++)
+    {
+        if(script.hasPoses())
+        {
+            //the ship is placed by the script, physics must not move it on its own
+            m_btShip->setWorldTransform(script.getPose(frame));
+            m_btShip->setLinearVelocity(btVector3(0, 0, 0));
+            m_btShip->setAngularVelocity(btVector3(0, 0, 0));
+        }
+        if(script.isShot(frame))
+        {
+            shoot();
+        }
+        updatePhysics(script.getTimeStep());
+        m_irrDevice->run();
+    }
+
+    std::cout << "Simulated " << script.getFrames() << " frames of " << script.getTimeStep() << " ms in "
+              << wall.elapsed() << " s\n";
+    //fractures still in flight would be missing from the statistics
+    m_resolver->drain();
+    std::cout << "Fracture pipeline drained at " << wall.elapsed() << " s\n";
+    m_resolver->printStatistics(std::cout, wall.elapsed());
+}
+
 void gg::MGame::createStartScene()
 {
     // Create the initial scene
@@ -282,6 +341,7 @@ void gg::MGame::shoot()
     btVector3 position =
             m_btShip->getCenterOfMassPosition() + m_btShip->getWorldTransform().getBasis() * btVector3(0, -0.1, -0.5);
     btVector3 impulse = m_btShip->getWorldTransform().getBasis() * btVector3(0, 0, -200 + m_velocity);
+    m_resolver->prefetch(position, impulse);
     std::unique_ptr<MObject> shot(m_objectCreator->shoot(position, impulse));
     m_btWorld->addRigidBody(shot->getRigid());
     shot->getRigid()->setGravity(btVector3(0, 0, 0));
@@ -291,10 +351,18 @@ void gg::MGame::shoot()
 
 void gg::MGame::updatePhysics(u32 TDeltaTime)
 {
-    m_objects.erase(std::remove_if(m_objects.begin(), m_objects.end(),
-                                   [](auto &&x) { return x->deleted.load() && x->reference_count == 0; }),
-                    m_objects.end());
-    m_btWorld->stepSimulation(TDeltaTime * 0.001f, 1, 1. / 60.);
+    auto removed = std::stable_partition(m_objects.begin(), m_objects.end(),
+                                         [](auto &&x) { return !x->deleted.load() || x->reference_count != 0; });
+    for(auto i = removed; i != m_objects.end(); i++)
+    {
+        //a new object may be allocated at the same address
+        m_resolver->forget(i->get());
+    }
+    m_objects.erase(removed, m_objects.end());
+    {
+        MTraceSpan span("stepSimulation");
+        m_btWorld->stepSimulation(TDeltaTime * 0.001f, 1, 1. / 60.);
+    }
     for(auto &&object : m_objects)
     {
         if(!object->isDeleted())
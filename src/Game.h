@@ -10,6 +10,9 @@
 #include "Loader.h"
 #include "CollisionResolver.h"
 #include "ObjectCreator.h"
+#include "Settings.h"
+#include "Script.h"
+#include "Trace.h"
 
 #include <irrlicht.h>
 #include <btBulletCollisionCommon.h>
@@ -25,17 +28,23 @@ namespace gg
     class MGame
     {
     public:
-        void run(bool debug);
+        void run();
 
         ~MGame();
 
-        MGame();
+        MGame(const MSettings &settings = MSettings());
 
         MGame(const MGame &) = delete;
 
         MGame &operator=(const MGame &) = delete;
 
     private:
+        void runInteractive();
+
+        void runHeadless(const MScript &script);
+
+        void loadWorld(std::string level);
+
         void createStartScene();
 
         void createEngineGlow(irr::scene::ISceneNode *parent);
@@ -68,6 +77,7 @@ namespace gg
         std::vector<std::unique_ptr<MObject>> m_objects;
         std::unique_ptr<MCollisionResolver> m_resolver;
         MEventReceiver *m_events;
+        MSettings m_settings;
 
         float m_velocity;
         irr::u32 m_shot_time = 0;
@@ -0,0 +1,181 @@
+#include "Geometry.h"
+#include "FastBoolean.h"
+
+gg::MGeometry::MGeometry(MeshManipulators::Nef_polyhedron nef) : m_nef(std::move(nef)), m_hasNef(true)
+{}
+
+gg::MGeometry::MGeometry(MeshManipulators::Surface_mesh surface) : m_surface(std::move(surface)), m_hasSurface(true)
+{}
+
+gg::MGeometry::MGeometry(MTriangleMesh mesh) : m_mesh(std::make_shared<MTriangleMesh>(std::move(mesh))),
+                                                m_hasMesh(true), m_ownsMesh(true)
+{}
+
+gg::MGeometry::MGeometry(std::shared_ptr<const MTriangleMesh> mesh) : m_mesh(std::move(mesh)), m_hasMesh(true)
+{}
+
+bool gg::MGeometry::empty() const
+{
+    if(m_hasNef)
+    {
+        return m_nef.is_empty();
+    }
+    if(m_hasSurface)
+    {
+        return m_surface.number_of_faces() == 0;
+    }
+    return !m_mesh || m_mesh->empty();
+}
+
+gg::MeshManipulators::Nef_polyhedron &gg::MGeometry::nef()
+{
+    if(!m_hasNef)
+    {
+        m_nef = MeshManipulators::makeNefPolyhedron(mesh());
+        m_hasNef = true;
+    }
+    return m_nef;
+}
+
+gg::MeshManipulators::Surface_mesh &gg::MGeometry::surface()
+{
+    if(!m_hasSurface)
+    {
+        m_surface = MeshManipulators::makeSurfaceMesh(mesh());
+        m_hasSurface = true;
+    }
+    return m_surface;
+}
+
+const gg::MTriangleMesh &gg::MGeometry::mesh()
+{
+    if(!m_hasMesh)
+    {
+        if(m_hasSurface)
+        {
+            m_mesh = std::make_shared<MTriangleMesh>(MeshManipulators::convertToTriangleMesh(m_surface));
+        }
+        else if(m_hasNef)
+        {
+            m_mesh = std::make_shared<MTriangleMesh>(MeshManipulators::convertToTriangleMesh(m_nef));
+        }
+        else
+        {
+            m_mesh = std::make_shared<MTriangleMesh>();
+        }
+        m_hasMesh = true;
+        m_ownsMesh = true;
+    }
+    return *m_mesh;
+}
+
+gg::MGeometry gg::MGeometry::meshOnly()
+{
+    index();
+    MGeometry copy;
+    copy.m_mesh = m_mesh;
+    copy.m_index = m_index;
+    copy.m_hasMesh = true;
+    copy.m_ownsMesh = m_ownsMesh;
+    return copy;
+}
+
+gg::MTriangleMesh gg::MGeometry::subtractFast(const MTriangleMesh &cutter)
+{
+    mesh();
+    //nobody else can take a reference to a mesh this geometry holds alone, it is copied otherwise
+    if(!m_ownsMesh || m_mesh.use_count() > 1)
+    {
+        m_mesh = std::make_shared<MTriangleMesh>(*m_mesh);
+        m_index.reset();
+        m_ownsMesh = true;
+    }
+    index();
+    MTriangleMesh inside(MFastBoolean::subtract(const_cast<MTriangleMesh &>(*m_mesh), *m_index, cutter));
+    m_nef = MeshManipulators::Nef_polyhedron();
+    m_surface = MeshManipulators::Surface_mesh();
+    m_hasNef = false;
+    m_hasSurface = false;
+    return inside;
+}
+
+gg::MTriangleMesh gg::MGeometry::intersectFast(const MTriangleMesh &cutter)
+{
+    return MFastBoolean::intersect(mesh(), index(), cutter);
+}
+
+const gg::MTriangleIndex &gg::MGeometry::index()
+{
+    if(!m_index)
+    {
+        m_index = std::make_shared<MTriangleIndex>(mesh());
+    }
+    return *m_index;
+}
+
+std::vector<gg::MGeometry> gg::MGeometry::split()
+{
+    std::vector<MGeometry> parts;
+    if(m_hasSurface)
+    {
+        for(auto &&part : MeshManipulators::splitPolyhedron(m_surface))
+        {
+            parts.emplace_back(std::move(part));
+        }
+    }
+    else if(m_hasMesh && m_index && m_mesh->shellCount() == 1)
+    {
+        //a mesh in one piece keeps its index, so the next cut of it stays local
+        parts.push_back(meshOnly());
+    }
+    else if(m_hasMesh)
+    {
+        for(auto &&component : m_mesh->components())
+        {
+            parts.emplace_back(std::move(component));
+        }
+    }
+    else if(m_hasNef)
+    {
+        for(auto &&part : MeshManipulators::splitPolyhedron(m_nef))
+        {
+            parts.emplace_back(std::move(part));
+        }
+    }
+    return parts;
+}
+
+std::tuple<irr::scene::IMesh *, irr::core::vector3df> gg::MGeometry::convertToMesh()
+{
+    if(m_hasMesh)
+    {
+        return MeshManipulators::convertPolyToMesh(*m_mesh);
+    }
+    if(m_hasSurface)
+    {
+        return MeshManipulators::convertPolyToMesh(m_surface);
+    }
+    if(m_hasNef)
+    {
+        return MeshManipulators::convertPolyToMesh(m_nef);
+    }
+    return std::make_tuple(nullptr, irr::core::vector3df());
+}
+
+long gg::MGeometry::vertexCount() const
+{
+    if(m_hasNef)
+    {
+        return static_cast<long>(m_nef.number_of_vertices());
+    }
+    return static_cast<long>(m_hasSurface ? m_surface.number_of_vertices() : (m_mesh ? m_mesh->vertexCount() : 0));
+}
+
+long gg::MGeometry::facetCount() const
+{
+    if(m_hasNef)
+    {
+        return static_cast<long>(m_nef.number_of_facets());
+    }
+    return static_cast<long>(m_hasSurface ? m_surface.number_of_faces() : (m_mesh ? m_mesh->triangleCount() : 0));
+}
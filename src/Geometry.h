@@ -0,0 +1,93 @@
+/*
+ * geometry of a destructible object in the representation the last operation produced it in.
+ * The exact Nef polyhedron, the corefinable surface mesh and the floating-point triangle mesh
+ * are converted into each other only when another one is asked for, the conversion is then kept
+ * next to the original. Conversions between the exact representations go through the triangle mesh.
+ * Copies of a geometry share its triangle mesh; instances of one asset keep a single mesh until each
+ * of them is cut and gets a result of its own. The fast booleans cut a mesh in place, with the spatial
+ * index of its triangles kept next to it, but only a mesh no other geometry shares, any other is copied first.
+ * A geometry is not synchronized, its object is locked while it is read or replaced.
+ */
+
+#ifndef GEOMETRY_H
+#define GEOMETRY_H
+
+#include "MeshManipulators.h"
+#include "TriangleIndex.h"
+#include "TriangleMesh.h"
+
+#include <memory>
+#include <tuple>
+#include <vector>
+
+namespace gg
+{
+
+    class MGeometry
+    {
+    public:
+        MGeometry() = default;
+
+        explicit MGeometry(MeshManipulators::Nef_polyhedron nef);
+
+        explicit MGeometry(MeshManipulators::Surface_mesh surface);
+
+        explicit MGeometry(MTriangleMesh mesh);
+
+        explicit MGeometry(std::shared_ptr<const MTriangleMesh> mesh);
+
+        inline bool hasNef() const
+        { return m_hasNef; }
+
+        inline bool hasSurface() const
+        { return m_hasSurface; }
+
+        inline bool hasMesh() const
+        { return m_hasMesh; }
+
+        bool empty() const;
+
+        MeshManipulators::Nef_polyhedron &nef();
+
+        MeshManipulators::Surface_mesh &surface();
+
+        const MTriangleMesh &mesh();
+
+        //copy of the triangle mesh and its index alone, the copies only read them,
+        //so it can be handed to other threads
+        MGeometry meshOnly();
+
+        //cuts the convex cutter out of the triangle mesh and returns the part inside it, the other representations
+        //are dropped; throws MFastBoolean::Degenerate and stays as it was when the fast booleans refuse the cut
+        MTriangleMesh subtractFast(const MTriangleMesh &cutter);
+
+        //the part of the triangle mesh inside the convex cutter, throws MFastBoolean::Degenerate
+        MTriangleMesh intersectFast(const MTriangleMesh &cutter);
+
+        //connected parts, split in the representation the geometry already has
+        std::vector<MGeometry> split();
+
+        //render mesh centred on its bounding box and the centre
+        std::tuple<irr::scene::IMesh *, irr::core::vector3df> convertToMesh();
+
+        //sizes reported in the telemetry labels, of the Nef polyhedron when there is one
+        long vertexCount() const;
+
+        long facetCount() const;
+
+    private:
+        const MTriangleIndex &index();
+
+        MeshManipulators::Nef_polyhedron m_nef;
+        MeshManipulators::Surface_mesh m_surface;
+        std::shared_ptr<const MTriangleMesh> m_mesh;
+        //built with the mesh on the first fast cut, shared with it
+        std::shared_ptr<MTriangleIndex> m_index;
+        bool m_hasNef = false, m_hasSurface = false, m_hasMesh = false;
+        //the mesh was created by a geometry and not passed in as const, so it can be cut in place
+        bool m_ownsMesh = false;
+    };
+
+}
+
+#endif // GEOMETRY_H
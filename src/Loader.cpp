@@ -1,6 +1,7 @@
 #include "Loader.h"
 #include <fstream>
 #include <sstream>
+#include <functional>
 
 using namespace irr;
 using namespace core;
@@ -16,6 +17,7 @@ gg::MLoader::MLoader(irr::IrrlichtDevice *device) : m_irrDevice(device)
 std::vector<std::unique_ptr<gg::MObject>> gg::MLoader::load(std::string level)
 {
     m_objects = std::vector<std::unique_ptr<gg::MObject>>();
+    m_prefractures.clear();
     m_objectCreator.reset(new MObjectCreator(m_irrDevice));
 
     std::string current_line;
@@ -51,9 +53,23 @@ std::vector<std::unique_ptr<gg::MObject>> gg::MLoader::load(std::string level)
     {
         if(current_line != "")
         {
-            std::unique_ptr<MObject> obj(m_objectCreator->createMeshRigidBody(split(std::stringstream(current_line))));
+            std::vector<std::string> items(split(std::stringstream(current_line)));
+            //optional tenth item is the number of chunks the object is broken into in advance
+            unsigned chunks = 0;
+            std::string asset;
+            if(items.size() == 10)
+            {
+                chunks = static_cast<unsigned>(std::stoul(items[9]));
+                items.pop_back();
+                asset = items[0] + ";" + items[5] + ";" + items[6] + ";" + items[7] + ";" + std::to_string(chunks);
+            }
+            std::unique_ptr<MObject> obj(m_objectCreator->createMeshRigidBody(std::move(items)));
             if(obj)
             {
+                if(chunks > 0)
+                {
+                    prefracture(obj.get(), asset, chunks);
+                }
                 m_objects.push_back(std::move(obj));
             }
         }
@@ -83,6 +99,31 @@ bool gg::MLoader::loadSkybox(std::vector<std::string> &&files)
     return true;
 }
 
+void gg::MLoader::prefracture(MObject *object, const std::string &asset, unsigned count)
+{
+    auto found = m_prefractures.find(asset);
+    if(found == m_prefractures.end())
+    {
+        MTriangleMesh mesh(object->getGeometry().mesh());
+        unsigned seed = static_cast<unsigned>(std::hash<std::string>()(asset));
+        auto pattern = std::async(std::launch::async, [mesh, count, seed]() -> std::shared_ptr<const MPrefracture> {
+            //an exception stored in the future would be rethrown in the game loop, a failed pattern
+            //leaves the objects of the asset to the booleans instead; a partial one would leave holes
+            try
+            {
+                return MPrefracture::compute(mesh, count, seed);
+            }
+            catch(...)
+            {
+                std::cerr << "Pre-fracture failed, the object is cut as usual\n";
+                return nullptr;
+            }
+        });
+        found = m_prefractures.insert(std::make_pair(asset, pattern.share())).first;
+    }
+    object->prefracture = found->second;
+}
+
 std::vector<std::string> gg::MLoader::split(std::stringstream &&input)
 {
     std::vector<std::string> parts;
@@ -8,6 +8,7 @@
 
 #include "Object.h"
 #include "ObjectCreator.h"
+#include "Prefracture.h"
 
 #include <irrlicht.h>
 #include <btBulletCollisionCommon.h>
@@ -18,6 +19,8 @@
 #include <string>
 #include <tuple>
 #include <memory>
+#include <future>
+#include <map>
 
 namespace gg
 {
@@ -36,9 +39,15 @@ namespace gg
 
         std::vector<std::string> split(std::stringstream &&);
 
+        //starts breaking the object into count chunks in the background, unless an object of the same
+        //asset has started it already
+        void prefracture(MObject *object, const std::string &asset, unsigned count);
+
         irr::IrrlichtDevice *m_irrDevice;
         std::vector<std::unique_ptr<gg::MObject>> m_objects;
         std::unique_ptr<MObjectCreator> m_objectCreator;
+        //patterns by the file, scale and number of chunks of the object
+        std::map<std::string, std::shared_future<std::shared_ptr<const MPrefracture>>> m_prefractures;
     };
 
 }
@@ -1,8 +1,18 @@
 #include "MeshManipulators.h"
+#include "FastBoolean.h"
+#include "VertexWelder.h"
 #include <CGAL/number_utils.h>
+#if GG_COREFINEMENT
+#include <CGAL/Polygon_mesh_processing/connected_components.h>
+#include <CGAL/Polygon_mesh_processing/corefinement.h>
+#endif
 #include <CGAL/Polygon_mesh_processing/triangulate_faces.h>
 #include <CGAL/Inverse_index.h>
-#include <map>
+#include <boost/optional.hpp>
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <stdexcept>
 
 using namespace irr;
 using namespace core;
@@ -13,71 +23,20 @@ using namespace gui;
 using namespace CGAL;
 
 
-std::tuple<IMesh *, vector3df> gg::MeshManipulators::convertPolyToMesh(gg::MeshManipulators::Nef_polyhedron &NefPoly)
+CDynamicMeshBuffer *gg::MeshManipulators::createMeshBuffer(u32 vertexCount, u32 indexCount)
 {
-    Polyhedron poly;
-    NefPoly.convert_to_polyhedron(poly);
-
-    Polygon_mesh_processing::triangulate_faces(poly,
-                                               CGAL::Polygon_mesh_processing::parameters::use_delaunay_triangulation(
-                                                       true));
-
-    if(poly.size_of_vertices() == 0)
-    {
-        return std::make_tuple(nullptr, vector3df());
-    }
-
-    vector3df min(1000,1000,1000), max(-1000,-1000,-1000);
-    irr::scene::SMesh *mesh = new SMesh();
-    irr::scene::SMeshBuffer *buf = 0;
-    buf = new SMeshBuffer();
-    mesh->addMeshBuffer(buf);
-    buf->drop();
-    buf->Vertices.reallocate(poly.size_of_vertices() * 3);
-    buf->Vertices.set_used(poly.size_of_vertices() * 3);
-    buf->Indices.reallocate(poly.size_of_facets() * 3);
-    buf->Indices.set_used(poly.size_of_facets() * 3);
-    int i = 0;
-    for(auto p = poly.points_begin(); p != poly.points_end(); p++)
-    {
-        double a = CGAL::to_double(p->x());
-        double b = CGAL::to_double(p->y());
-        double c = CGAL::to_double(p->z());
-        buf->Vertices[i] = S3DVertex(a, b, c, a, b, c, video::SColor(255, 200, 200, 200), 0,
-                                     0);
-        vector3df current(a,b,c);
-        min = current < min ? current : min;
-        max = current > max ? current : max;
-        i++;
-    }
-
-    typedef Polyhedron::Vertex_const_iterator VCI;
-    typedef CGAL::Inverse_index<VCI> Index;
-    Index index(poly.vertices_begin(), poly.vertices_end());
-    i = 0;
-    for(auto f = poly.facets_begin(); f != poly.facets_end(); f++)
-    {
-        auto hfc = f->facet_begin();
-        CGAL_assertion(CGAL::circulator_size(hfc) == 3);
-        for(int j = 0; j < 3; j++)
-        {
-            buf->Indices[i * 3 + j] = index[VCI(hfc->vertex())];
-            hfc++;
-        }
-        i++;
-    }
-    //centralize mesh center of mass
-    mesh->recalculateBoundingBox();
-    vector3df center = min + (max-min)/2;
-    S3DVertex *vertices = (S3DVertex *) buf->getVertices();
-    for(u32 i = 0; i < buf->getVertexCount(); i++)
-    {
-        vertices[i].Pos = vertices[i].Pos - center;
-    }
-    mesh->recalculateBoundingBox();
+    //16-bit indices halve the index memory of the many small fragments
+    CDynamicMeshBuffer *buf = new CDynamicMeshBuffer(EVT_STANDARD, vertexCount > 0x10000 ? EIT_32BIT : EIT_16BIT);
+    buf->getVertexBuffer().reallocate(vertexCount);
+    buf->getVertexBuffer().set_used(vertexCount);
+    buf->getIndexBuffer().reallocate(indexCount);
+    buf->getIndexBuffer().set_used(indexCount);
+    return buf;
+}
 
-//    NefPoly = makeNefPolyhedron(mesh);
-    return std::make_tuple(mesh,center);
+std::tuple<IMesh *, vector3df> gg::MeshManipulators::convertPolyToMesh(gg::MeshManipulators::Nef_polyhedron &NefPoly)
+{
+    return convertPolyToMesh(convertToTriangleMesh(NefPoly));
 }
 
 btCollisionShape *gg::MeshManipulators::convertMesh(IMeshSceneNode *node)
@@ -93,16 +52,16 @@ btCollisionShape *gg::MeshManipulators::convertMesh(IMesh *mesh)
     {
         IMeshBuffer *meshBuffer = mesh->getMeshBuffer(j);
         S3DVertex *vertices = (S3DVertex *) meshBuffer->getVertices();
-        u16 *indices = meshBuffer->getIndices();
-
-        for(u32 i = 0; i < meshBuffer->getIndexCount(); i += 3)
-        {
-            vector3df point1 = vertices[indices[i]].Pos;
-            vector3df point2 = vertices[indices[i + 1]].Pos;
-            vector3df point3 = vertices[indices[i + 2]].Pos;
-            btMesh->addTriangle(btVector3(point1.X, point1.Y, point1.Z), btVector3(point2.X, point2.Y, point2.Z),
-                                btVector3(point3.X, point3.Y, point3.Z));
-        }
+        visitIndices(meshBuffer, [&](auto indices) {
+            for(u32 i = 0; i < meshBuffer->getIndexCount(); i += 3)
+            {
+                vector3df point1 = vertices[indices[i]].Pos;
+                vector3df point2 = vertices[indices[i + 1]].Pos;
+                vector3df point3 = vertices[indices[i + 2]].Pos;
+                btMesh->addTriangle(btVector3(point1.X, point1.Y, point1.Z), btVector3(point2.X, point2.Y, point2.Z),
+                                    btVector3(point3.X, point3.Y, point3.Z));
+            }
+        });
     }
 
     btBvhTriangleMeshShape *sh = new btBvhTriangleMeshShape(btMesh, true);
@@ -135,77 +94,121 @@ btCollisionShape *gg::MeshManipulators::nefToShape(gg::MeshManipulators::Nef_pol
     return shape;
 }
 
-IMesh *gg::MeshManipulators::convertMesh(voro::voronoicell &cell)
+std::tuple<gg::MeshManipulators::Nef_polyhedron, gg::MeshManipulators::Nef_polyhedron>
+    gg::MeshManipulators::subtractMesh(gg::MeshManipulators::Nef_polyhedron &nef, const Cutter &cutter)
 {
-    std::vector<double> vertices;
-    std::vector<int> face_vertices;
-    cell.vertices(vertices);
-    cell.face_vertices(face_vertices);
-
-    SMesh *mesh = new SMesh();
-    SMeshBuffer *buf = 0;
-    buf = new SMeshBuffer();
-    mesh->addMeshBuffer(buf);
-    buf->drop();
-    buf->Vertices.reallocate(vertices.size());
-    buf->Vertices.set_used(vertices.size());
-    for(int i = 0; i < static_cast<int>(vertices.size()); i++)
-    {
-        buf->Vertices[i] = S3DVertex(float(vertices[i]), float(vertices[i + 1]), float(vertices[i + 2]),
-                                     float(vertices[i]), float(vertices[i + 1]), float(vertices[i + 2]),
-                                     video::SColor(255, rand() % 256, rand() % 256, rand() % 256), 0, 0);
-    }
-    buf->Indices.reallocate(face_vertices.size() * 10);
+    return subtractMesh(nef, std::vector<Cutter>{cutter});
+}
 
-    int indices = 0;
-    for(int i = 0; i < static_cast<int>(face_vertices.size());)
+std::tuple<gg::MeshManipulators::Nef_polyhedron, gg::MeshManipulators::Nef_polyhedron>
+    gg::MeshManipulators::subtractMesh(gg::MeshManipulators::Nef_polyhedron &nef, const std::vector<Cutter> &cutters)
+{
+    //the cutters are small, joining them is cheap compared to overlaying the whole object with each of them;
+    //the public Nef interface has no operation giving both parts of one overlay, so the object is still
+    //overlaid twice, once for the difference and once for the intersection
+    Nef_polyhedron cutter;
+    bool empty = true;
+    for(auto &&c : cutters)
     {
-        for(int j = 1; j < face_vertices[i] - 1; j++)
+        if(!std::get<0>(c))
+        {
+            continue;
+        }
+        MTriangleMesh placed(placeCutter(c));
+        if(placed.isClosed())
         {
-            buf->Indices[indices] = face_vertices[i + 1] * 3;
-            buf->Indices[indices + 1] = face_vertices[i + j + 2] * 3;
-            buf->Indices[indices + 2] = face_vertices[i + j + 1] * 3;
-            indices += 3;
+            Nef_polyhedron N2(makeNefPolyhedron(placed));
+            cutter = empty ? std::move(N2) : cutter + N2;
+            empty = false;
         }
-        i += face_vertices[i] + 1;
     }
 
-    buf->Indices.set_used(indices);
-    buf->recalculateBoundingBox();
+    Nef_polyhedron intersection;
+    if(!empty)
+    {
+        Nef_polyhedron difference(nef - cutter);
+        intersection = nef * cutter;
+        return std::move(std::make_tuple(std::move(difference), std::move(intersection)));
+    }
+    return std::move(std::make_tuple(nef, std::move(intersection)));
+}
 
-    return mesh;
+gg::MeshManipulators::Nef_polyhedron gg::MeshManipulators::intersectMesh(const Nef_polyhedron &nef, const Cutter &cutter)
+{
+    return nef * makeNefPolyhedron(placeCutter(cutter));
 }
 
-std::tuple<gg::MeshManipulators::Nef_polyhedron, gg::MeshManipulators::Nef_polyhedron>
-    gg::MeshManipulators::subtractMesh(gg::MeshManipulators::Nef_polyhedron &nef, IMesh *what, vector3df position)
+std::vector<gg::MeshManipulators::Nef_polyhedron> gg::MeshManipulators::partitionMesh(const Nef_polyhedron &nef,
+                                                                                     const Cutter &shatter)
 {
-    Nef_polyhedron intersection;
-    if(what)
+    std::shared_ptr<const std::vector<MTriangleMesh>> cells(std::get<3>(shatter));
+    if(!cells || cells->empty())
     {
-        Polyhedron poly_what;
-        PolyhedronBuilder mesh_what(what, position);
-        poly_what.delegate(mesh_what);
+        return {nef};
+    }
 
-        if(poly_what.is_closed())
+    //the walls are joined pairwise, so the overlays are of the small cells and not of their growing union
+    std::vector<Nef_polyhedron> walls;
+    for(auto &&cell : *cells)
+    {
+        Cutter cellCutter(shatter);
+        std::get<0>(cellCutter) = std::shared_ptr<const MTriangleMesh>(cells, &cell);
+        std::get<3>(cellCutter) = nullptr;
+        walls.push_back(makeNefPolyhedron(placeCutter(cellCutter)).boundary());
+    }
+    for(size_t step = 1; step < walls.size(); step *= 2)
+    {
+        for(size_t i = 0; i + step < walls.size(); i += 2 * step)
         {
-            Nef_polyhedron N2(poly_what);
-            Nef_polyhedron difference(nef - N2);
-            intersection = nef * N2;
-            return std::move(std::make_tuple(std::move(difference), std::move(intersection)));
+            walls[i] = walls[i] + walls[i + step];
         }
     }
-    return std::move(std::make_tuple(std::move(nef), std::move(intersection)));
+    Nef_polyhedron divided(nef - walls.front());
+
+    std::vector<Polyhedron> parts, cavities;
+    std::vector<bool> hollow;
+    for(auto i = ++divided.volumes_begin(); i != divided.volumes_end(); i++)
+    {
+        Polyhedron shell;
+        divided.convert_inner_shell_to_polyhedron(i->shells_begin(), shell);
+        if(i->mark())
+        {
+            auto inner = i->shells_begin();
+            hollow.push_back(++inner != i->shells_end());
+            parts.push_back(std::move(shell));
+        }
+        else
+        {
+            cavities.push_back(std::move(shell));
+        }
+    }
+
+    //the outer shell of a hollow part closes its cavities too, they are taken out again
+    Nef_polyhedron holes;
+    if(std::find(hollow.begin(), hollow.end(), true) != hollow.end())
+    {
+        for(auto &&cavity : cavities)
+        {
+            holes += Nef_polyhedron(cavity);
+        }
+    }
+    std::vector<Nef_polyhedron> result;
+    for(size_t i = 0; i < parts.size(); i++)
+    {
+        result.emplace_back(parts[i]);
+        if(hollow[i])
+        {
+            result.back() = (result.back() - holes).regularization();
+        }
+    }
+    return result;
 }
 
 gg::MeshManipulators::Nef_polyhedron gg::MeshManipulators::makeNefPolyhedron(IMesh *obj)
 {
     if(obj)
     {
-        Polyhedron poly_mesh;
-        PolyhedronBuilder mesh_build(obj);
-        poly_mesh.delegate(mesh_build);
-        Nef_polyhedron N(poly_mesh);
-        return std::move(N);
+        return makeNefPolyhedron(convertToTriangleMesh(obj));
     }
     return Nef_polyhedron();
 }
@@ -213,161 +216,539 @@ gg::MeshManipulators::Nef_polyhedron gg::MeshManipulators::makeNefPolyhedron(IMe
 std::vector<gg::MeshManipulators::Nef_polyhedron>
     gg::MeshManipulators::splitPolyhedron(gg::MeshManipulators::Nef_polyhedron poly)
 {
-    std::vector<MeshManipulators::Nef_polyhedron> splitPolies;
-    PolyhedronSplitter splitter;
-    Polyhedron p;
+    std::vector<Nef_polyhedron> out;
+    Indexed_polyhedron p;
     poly.convert_to_polyhedron(p);
-    splitPolies = splitter.run(p);
-    return splitPolies;
+    CGAL::set_halfedgeds_items_id(p);
+
+    std::vector<uint32_t> parents(p.size_of_facets());
+    std::iota(parents.begin(), parents.end(), 0);
+    auto findRoot = [&parents](uint32_t i) {
+        while(parents[i] != i)
+        {
+            parents[i] = parents[parents[i]];
+            i = parents[i];
+        }
+        return i;
+    };
+    for(auto he = p.halfedges_begin(); he != p.halfedges_end(); he++)
+    {
+        if(he->is_border() || he->opposite()->is_border())
+        {
+            continue;
+        }
+        uint32_t a = findRoot(static_cast<uint32_t>(he->facet()->id()));
+        uint32_t b = findRoot(static_cast<uint32_t>(he->opposite()->facet()->id()));
+        if(a != b)
+        {
+            parents[std::max(a, b)] = std::min(a, b);
+        }
+    }
+
+    //dense numbering of the parts
+    std::vector<uint32_t> partOf(parents.size(), UINT32_MAX);
+    uint32_t partCount = 0;
+    for(uint32_t i = 0; i < parents.size(); i++)
+    {
+        uint32_t root = findRoot(i);
+        if(partOf[root] == UINT32_MAX)
+        {
+            partOf[root] = partCount++;
+        }
+        partOf[i] = partOf[root];
+    }
+    if(partCount < 2)
+    {
+        if(partCount == 1)
+        {
+            out.push_back(std::move(poly));
+        }
+        return out;
+    }
+
+    std::vector<PolygonMesh> parts(partCount);
+    std::vector<uint32_t> remap(p.size_of_vertices(), UINT32_MAX);
+    for(auto f = p.facets_begin(); f != p.facets_end(); f++)
+    {
+        PolygonMesh &part = parts[partOf[f->id()]];
+        part.faces.push_back(static_cast<uint32_t>(f->facet_degree()));
+        part.faceCount++;
+        auto he = f->facet_begin();
+        do
+        {
+            size_t v = he->vertex()->id();
+            if(remap[v] == UINT32_MAX)
+            {
+                remap[v] = static_cast<uint32_t>(part.points.size());
+                part.points.push_back(he->vertex()->point());
+            }
+            part.faces.push_back(remap[v]);
+        } while(++he != f->facet_begin());
+    }
+    for(auto &&part : parts)
+    {
+        Polyhedron component;
+        PolygonMeshBuilder builder(part);
+        component.delegate(builder);
+        out.emplace_back(component);
+    }
+    return out;
 }
 
-void gg::MeshManipulators::PolyhedronBuilder::operator()(gg::MeshManipulators::HalfedgeDS &hds)
+//all corners of the facet turn the same way; facets with collinear corners are not taken as convex
+static bool isConvex(gg::MeshManipulators::Polyhedron::Facet_const_handle facet)
 {
-    CGAL::Polyhedron_incremental_builder_3<HalfedgeDS> B(hds, true);
-    typedef typename HalfedgeDS::Vertex Vertex;
-    typedef typename Vertex::Point Point;
-    std::map<irr::core::vector3df, int> vertex_map;
+    auto h = facet->facet_begin();
+    if(CGAL::circulator_size(h) == 3)
+    {
+        return true;
+    }
+    CGAL::Orientation turn = CGAL::COLLINEAR;
+    auto end = h;
+    do
+    {
+        CGAL::Orientation current = CGAL::coplanar_orientation(h->vertex()->point(), h->next()->vertex()->point(),
+                                                               h->next()->next()->vertex()->point());
+        if(current == CGAL::COLLINEAR || (turn != CGAL::COLLINEAR && current != turn))
+        {
+            return false;
+        }
+        turn = current;
+    } while(++h != end);
+    return true;
+}
+
+gg::MTriangleMesh gg::MeshManipulators::convertToTriangleMesh(gg::MeshManipulators::Nef_polyhedron &NefPoly)
+{
+    Polyhedron poly;
+    NefPoly.convert_to_polyhedron(poly);
 
-    uint n_faces = 0, n_vertices = 0;
-    for(irr::u32 j = 0; j < m_mesh->getMeshBufferCount(); j++)
+    //convex facets are cut into fans below, only the others need the Delaunay triangulation
+    std::vector<Polyhedron::Facet_handle> concave;
+    for(auto f = poly.facets_begin(); f != poly.facets_end(); f++)
     {
-        IMeshBuffer *meshBuffer = m_mesh->getMeshBuffer(j);
-        n_faces += meshBuffer->getIndexCount() / 3;
-        n_vertices += meshBuffer->getVertexCount();
+        if(!isConvex(f))
+        {
+            concave.push_back(f);
+        }
     }
-    B.begin_surface(n_vertices, n_faces);
-    int v = 0;
-    for(irr::u32 j = 0; j < m_mesh->getMeshBufferCount(); j++)
+    for(auto &&f : concave)
     {
-        IMeshBuffer *meshBuffer = m_mesh->getMeshBuffer(j);
+        Polygon_mesh_processing::triangulate_face(f, poly,
+                                                  CGAL::Polygon_mesh_processing::parameters::use_delaunay_triangulation(
+                                                          true));
+    }
+
+    MTriangleMesh mesh;
+    mesh.vertices.reserve(poly.size_of_vertices() * 3);
+    for(auto p = poly.points_begin(); p != poly.points_end(); p++)
+    {
+        mesh.vertices.push_back(CGAL::to_double(p->x()));
+        mesh.vertices.push_back(CGAL::to_double(p->y()));
+        mesh.vertices.push_back(CGAL::to_double(p->z()));
+    }
+
+    typedef Polyhedron::Vertex_const_iterator VCI;
+    typedef CGAL::Inverse_index<VCI> Index;
+    Index index(poly.vertices_begin(), poly.vertices_end());
+    //a facet of n corners gives n - 2 triangles
+    mesh.indices.reserve(3 * (poly.size_of_halfedges() - 2 * poly.size_of_facets()));
+    for(auto f = poly.facets_begin(); f != poly.facets_end(); f++)
+    {
+        auto hfc = f->facet_begin();
+        uint32_t first = static_cast<uint32_t>(index[VCI(hfc->vertex())]);
+        auto h = hfc;
+        ++h;
+        for(auto next = h; ++next != hfc; h = next)
+        {
+            mesh.indices.push_back(first);
+            mesh.indices.push_back(static_cast<uint32_t>(index[VCI(h->vertex())]));
+            mesh.indices.push_back(static_cast<uint32_t>(index[VCI(next->vertex())]));
+        }
+    }
+    return mesh;
+}
+
+gg::MTriangleMesh gg::MeshManipulators::convertToTriangleMesh(IMesh *obj, vector3df position, double epsilon)
+{
+    MTriangleMesh mesh;
+    size_t corners = 0;
+    for(irr::u32 j = 0; j < obj->getMeshBufferCount(); j++)
+    {
+        corners += obj->getMeshBuffer(j)->getIndexCount();
+    }
+    mesh.indices.reserve(corners);
+    MVertexWelder welder(mesh, corners, epsilon);
+    for(irr::u32 j = 0; j < obj->getMeshBufferCount(); j++)
+    {
+        IMeshBuffer *meshBuffer = obj->getMeshBuffer(j);
         S3DVertex *IVertices = (S3DVertex *) meshBuffer->getVertices();
-        u16 *IIndices = meshBuffer->getIndices();
+        visitIndices(meshBuffer, [&](auto IIndices) {
+            for(u32 i = 0; i < meshBuffer->getIndexCount(); i++)
+            {
+                const vector3df &vertex = IVertices[IIndices[i]].Pos;
+                mesh.indices.push_back(welder.add(double(vertex.X) + position.X,
+                                                  double(vertex.Y) + position.Y,
+                                                  double(vertex.Z) + position.Z));
+            }
+        });
+    }
+    return mesh;
+}
+
+gg::MTriangleMesh gg::MeshManipulators::placeCutter(const Cutter &cutter)
+{
+    MTriangleMesh mesh(*std::get<0>(cutter));
+    const vector3df &position = std::get<1>(cutter);
+    const f32 *m = std::get<2>(cutter).pointer();
+    for(size_t i = 0; i < mesh.vertices.size(); i += 3)
+    {
+        double x = mesh.vertices[i], y = mesh.vertices[i + 1], z = mesh.vertices[i + 2];
+        mesh.vertices[i] = x * m[0] + y * m[4] + z * m[8] + m[12] + position.X;
+        mesh.vertices[i + 1] = x * m[1] + y * m[5] + z * m[9] + m[13] + position.Y;
+        mesh.vertices[i + 2] = x * m[2] + y * m[6] + z * m[10] + m[14] + position.Z;
+    }
+    return mesh;
+}
+
+gg::MTriangleMesh gg::MeshManipulators::convertToTriangleMesh(voro::voronoicell &cell, double x, double y, double z)
+{
+    MTriangleMesh mesh;
+    std::vector<int> face_vertices;
+    cell.vertices(x, y, z, mesh.vertices);
+    cell.face_vertices(face_vertices);
+    for(size_t i = 0; i < face_vertices.size(); i += face_vertices[i] + 1)
+    {
+        for(int j = 1; j < face_vertices[i] - 1; j++)
+        {
+            mesh.indices.push_back(static_cast<uint32_t>(face_vertices[i + 1]));
+            mesh.indices.push_back(static_cast<uint32_t>(face_vertices[i + j + 1]));
+            mesh.indices.push_back(static_cast<uint32_t>(face_vertices[i + j + 2]));
+        }
+    }
+    if(mesh.volume() < 0)
+    {
+        for(size_t i = 0; i < mesh.indices.size(); i += 3)
+        {
+            std::swap(mesh.indices[i + 1], mesh.indices[i + 2]);
+        }
+    }
+    return mesh;
+}
 
-        for(u32 i = 0; i < meshBuffer->getIndexCount(); i += 3)
+std::tuple<IMesh *, vector3df> gg::MeshManipulators::convertPolyToMesh(const gg::MTriangleMesh &triangles)
+{
+    if(triangles.empty())
+    {
+        return std::make_tuple(nullptr, vector3df());
+    }
+
+    //render vertices of one mesh vertex, each shared by the corners whose triangles face the same way
+    struct Split
+    {
+        vector3df direction; //unit normal of the first triangle, zero while only degenerate ones joined
+        vector3df normal; //sum of the area-weighted normals of the triangles
+        uint32_t vertex;
+        uint32_t next;
+    };
+    std::vector<Split> splits;
+    splits.reserve(triangles.vertexCount());
+    std::vector<uint32_t> heads(triangles.vertexCount(), UINT32_MAX);
+    std::vector<uint32_t> corners(triangles.indices.size());
+    for(size_t i = 0; i < triangles.indices.size(); i += 3)
+    {
+        const double *a = &triangles.vertices[3 * static_cast<size_t>(triangles.indices[i])];
+        const double *b = &triangles.vertices[3 * static_cast<size_t>(triangles.indices[i + 1])];
+        const double *c = &triangles.vertices[3 * static_cast<size_t>(triangles.indices[i + 2])];
+        double u[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+        double v[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+        vector3df normal(f32(u[1] * v[2] - u[2] * v[1]), f32(u[2] * v[0] - u[0] * v[2]), f32(u[0] * v[1] - u[1] * v[0]));
+        vector3df direction(normal);
+        direction.normalize();
+        for(size_t j = i; j < i + 3; j++)
         {
-            vector3df vertexA = IVertices[IIndices[i]].Pos;
-            if(vertex_map.find(vertexA) == vertex_map.end())
+            uint32_t vertex = triangles.indices[j];
+            uint32_t split = heads[vertex];
+            while(split != UINT32_MAX && !direction.equals(vector3df(0, 0, 0)) &&
+                  !splits[split].direction.equals(vector3df(0, 0, 0)) &&
+                  splits[split].direction.dotProduct(direction) < CREASE_COSINE)
             {
-                B.add_vertex(Point(vertexA.X + m_position.X, vertexA.Y + m_position.Y, vertexA.Z + m_position.Z));
-                vertex_map[vertexA] = v;
-                v++;
+                split = splits[split].next;
             }
-            vector3df vertexB = IVertices[IIndices[i + 1]].Pos;
-            if(vertex_map.find(vertexB) == vertex_map.end())
+            if(split == UINT32_MAX)
             {
-                B.add_vertex(Point(vertexB.X + m_position.X, vertexB.Y + m_position.Y, vertexB.Z + m_position.Z));
-                vertex_map[vertexB] = v;
-                v++;
+                split = static_cast<uint32_t>(splits.size());
+                splits.push_back(Split{direction, vector3df(0, 0, 0), vertex, heads[vertex]});
+                heads[vertex] = split;
             }
-            vector3df vertexC = IVertices[IIndices[i + 2]].Pos;
-            if(vertex_map.find(vertexC) == vertex_map.end())
+            else if(splits[split].direction.equals(vector3df(0, 0, 0)))
             {
-                B.add_vertex(Point(vertexC.X + m_position.X, vertexC.Y + m_position.Y, vertexC.Z + m_position.Z));
-                vertex_map[vertexC] = v;
-                v++;
+                splits[split].direction = direction;
             }
-            B.begin_facet();
-            B.add_vertex_to_facet(vertex_map[vertexA]);
-            B.add_vertex_to_facet(vertex_map[vertexB]);
-            B.add_vertex_to_facet(vertex_map[vertexC]);
-            B.end_facet();
+            splits[split].normal += normal;
+            corners[j] = split;
         }
     }
-    B.end_surface();
+
+    //of the vertices the triangles use, a mesh cut in place holds others as well
+    const double *first = &triangles.vertices[3 * static_cast<size_t>(splits[0].vertex)];
+    aabbox3d<double> box(vector3d<double>(first[0], first[1], first[2]));
+    for(auto &&split : splits)
+    {
+        const double *p = &triangles.vertices[3 * static_cast<size_t>(split.vertex)];
+        box.addInternalPoint(p[0], p[1], p[2]);
+    }
+    vector3d<double> center(box.getCenter());
+
+    SMesh *mesh = new SMesh();
+    CDynamicMeshBuffer *buf = createMeshBuffer(splits.size(), triangles.indices.size());
+    mesh->addMeshBuffer(buf);
+    buf->drop();
+    IVertexBuffer &vertices = buf->getVertexBuffer();
+    for(u32 i = 0; i < splits.size(); i++)
+    {
+        const double *p = &triangles.vertices[3 * static_cast<size_t>(splits[i].vertex)];
+        vertices[i] = S3DVertex(f32(p[0] - center.X), f32(p[1] - center.Y), f32(p[2] - center.Z),
+                                0, 0, 0, video::SColor(255, 200, 200, 200), 0, 0);
+        vertices[i].Normal = splits[i].normal.normalize();
+    }
+    IIndexBuffer &indices = buf->getIndexBuffer();
+    for(u32 i = 0; i < corners.size(); i++)
+    {
+        indices.setValue(i, corners[i]);
+    }
+    buf->recalculateBoundingBox();
+    mesh->recalculateBoundingBox();
+    return std::make_tuple(mesh, vector3df(f32(center.X), f32(center.Y), f32(center.Z)));
 }
 
+gg::MeshManipulators::Nef_polyhedron gg::MeshManipulators::makeNefPolyhedron(const gg::MTriangleMesh &mesh)
+{
+    if(mesh.empty())
+    {
+        return Nef_polyhedron();
+    }
+    Polyhedron poly_mesh;
+    TriangleMeshBuilder mesh_build(mesh);
+    poly_mesh.delegate(mesh_build);
+    return Nef_polyhedron(poly_mesh);
+}
 
-std::vector<gg::MeshManipulators::Nef_polyhedron> gg::MeshManipulators::PolyhedronSplitter::run(gg::MeshManipulators::Polyhedron& polyhedron)
+std::tuple<gg::MTriangleMesh, std::vector<gg::MTriangleMesh>>
+    gg::MeshManipulators::subtractMesh(const gg::MTriangleMesh &mesh, const std::vector<Cutter> &cutters)
 {
-    std::vector<Nef_polyhedron> out;
-    std::set<Halfedge_handle, handle_compare<Halfedge_handle> > halfedges;
-    Polyhedron::Halfedge_iterator he;
-    for(he = polyhedron.halfedges_begin();
-        he != polyhedron.halfedges_end();
-        he++)
-    {
-        if(halfedges.find(he) == halfedges.end())
-        {
-            SplitModifier modifier(he,halfedges);
-            Polyhedron component;
-            component.delegate(modifier);
-            out.push_back(Nef_polyhedron(component));
+    std::vector<MTriangleMesh> cutterMeshes;
+    for(auto &&c : cutters)
+    {
+        if(std::get<0>(c))
+        {
+            cutterMeshes.push_back(placeCutter(c));
+        }
+    }
+    return MFastBoolean::subtract(mesh, cutterMeshes);
+}
+
+gg::MeshManipulators::Surface_mesh gg::MeshManipulators::makeSurfaceMesh(IMesh *obj, vector3df position)
+{
+    return makeSurfaceMesh(convertToTriangleMesh(obj, position));
+}
+
+gg::MeshManipulators::Surface_mesh gg::MeshManipulators::makeSurfaceMesh(const gg::MTriangleMesh &mesh)
+{
+    Surface_mesh surface;
+    surface.reserve(mesh.vertexCount(), mesh.indices.size() / 2, mesh.triangleCount());
+    //only the vertices the triangles use, a mesh cut in place holds others as well
+    std::vector<Surface_mesh::Vertex_index> vertices(mesh.vertexCount(), Surface_mesh::null_vertex());
+    for(auto &&index : mesh.indices)
+    {
+        if(vertices[index] == Surface_mesh::null_vertex())
+        {
+            vertices[index] = surface.add_vertex(Kernel::Point_3(mesh.vertices[index * 3], mesh.vertices[index * 3 + 1],
+                                                                 mesh.vertices[index * 3 + 2]));
+        }
+    }
+    for(size_t i = 0; i < mesh.indices.size(); i += 3)
+    {
+        if(surface.add_face(vertices[mesh.indices[i]], vertices[mesh.indices[i + 1]],
+                            vertices[mesh.indices[i + 2]]) == Surface_mesh::null_face())
+        {
+            throw std::runtime_error("mesh is not manifold");
+        }
+    }
+    return surface;
+}
+
+gg::MTriangleMesh gg::MeshManipulators::convertToTriangleMesh(const gg::MeshManipulators::Surface_mesh &surface)
+{
+    MTriangleMesh mesh;
+    mesh.vertices.reserve(surface.number_of_vertices() * 3);
+    mesh.indices.reserve(surface.number_of_faces() * 3);
+    //removed elements keep their indices until the garbage is collected
+    std::vector<uint32_t> index(surface.number_of_vertices() + surface.number_of_removed_vertices());
+    for(auto v : surface.vertices())
+    {
+        const Kernel::Point_3 &p = surface.point(v);
+        index[v] = static_cast<uint32_t>(mesh.vertexCount());
+        mesh.vertices.push_back(CGAL::to_double(p.x()));
+        mesh.vertices.push_back(CGAL::to_double(p.y()));
+        mesh.vertices.push_back(CGAL::to_double(p.z()));
+    }
+    for(auto f : surface.faces())
+    {
+        for(auto v : CGAL::vertices_around_face(surface.halfedge(f), surface))
+        {
+            mesh.indices.push_back(index[v]);
         }
     }
-    return std::move(out);
+    return mesh;
+}
+
+std::tuple<IMesh *, vector3df> gg::MeshManipulators::convertPolyToMesh(const gg::MeshManipulators::Surface_mesh &surface)
+{
+    return convertPolyToMesh(convertToTriangleMesh(surface));
 }
 
-void gg::MeshManipulators::SplitModifier::operator()(gg::MeshManipulators::HalfedgeDS& hds)
+std::tuple<gg::MeshManipulators::Surface_mesh, gg::MeshManipulators::Surface_mesh>
+    gg::MeshManipulators::subtractMesh(const gg::MeshManipulators::Surface_mesh &mesh, const std::vector<Cutter> &cutters)
 {
-    Faces faces;
-    Vertices vertices;
-    std::list<Vertex_handle> ordered_vertices;
-    std::map<Vertex_handle,int,handle_compare<Vertex_handle> > vertex_map;
-
-    // traverse component and fill sets
-    std::stack<Halfedge_handle> stack;
-    stack.push(m_seed_halfedge);
-    int vertex_index = 0;
-    while(!stack.empty())
-    {
-        // pop halfedge from queue
-        Halfedge_handle he = stack.top();
-        stack.pop();
-        m_halfedges.insert(he);
-
-        // let's see its incident face
-        if(!he->is_border())
-        {
-            Face_handle f = he->facet();
-            if(faces.find(f) == faces.end())
-                faces.insert(f);
+#if GG_COREFINEMENT
+    namespace PMP = CGAL::Polygon_mesh_processing;
+    Surface_mesh cutter;
+    bool empty = true;
+    for(auto &&c : cutters)
+    {
+        if(!std::get<0>(c))
+        {
+            continue;
+        }
+        Surface_mesh part(makeSurfaceMesh(placeCutter(c)));
+        if(!CGAL::is_closed(part))
+        {
+            continue;
         }
+        if(empty)
+        {
+            cutter = std::move(part);
+            empty = false;
+        }
+        else if(!PMP::corefine_and_compute_union(cutter, part, cutter))
+        {
+            throw std::runtime_error("cutters could not be joined");
+        }
+    }
+    if(empty)
+    {
+        return std::make_tuple(mesh, Surface_mesh());
+    }
 
-        // let's see its end vertex
-        Vertex_handle v = he->vertex();
-        if(vertices.find(v) == vertices.end())
+    //corefinement modifies its inputs, the object keeps its surface until the cut is applied
+    Surface_mesh object(mesh), difference, intersection;
+    std::array<boost::optional<Surface_mesh *>, 4> outputs;
+    outputs[PMP::Corefinement::TM1_MINUS_TM2] = &difference;
+    outputs[PMP::Corefinement::INTERSECTION] = &intersection;
+    std::array<bool, 4> valid = PMP::corefine_and_compute_boolean_operations(object, cutter, outputs);
+    if(!valid[PMP::Corefinement::TM1_MINUS_TM2] || !valid[PMP::Corefinement::INTERSECTION])
+    {
+        throw std::runtime_error("corefinement result is not manifold");
+    }
+    //exact evaluation drops the construction history the lazy kernel keeps for every new point
+    for(Surface_mesh *result : {&difference, &intersection})
+    {
+        for(auto v : result->vertices())
         {
-            vertices.insert(v);
-            ordered_vertices.push_back(v);
-            vertex_map[v] = vertex_index++;
+            CGAL::exact(result->point(v));
         }
+    }
+    return std::make_tuple(std::move(difference), std::move(intersection));
+#else
+    throw std::runtime_error("corefinement needs CGAL 5.1");
+#endif
+}
 
-        // go and discover component
-        Halfedge_handle nhe = he->next();
-        Halfedge_handle ohe = he->opposite();
-        if(m_halfedges.find(nhe) == m_halfedges.end())
-            stack.push(nhe);
-        if(m_halfedges.find(ohe) == m_halfedges.end())
-            stack.push(ohe);
+gg::MeshManipulators::Surface_mesh gg::MeshManipulators::intersectMesh(const Surface_mesh &mesh, const Cutter &cutter)
+{
+#if GG_COREFINEMENT
+    namespace PMP = CGAL::Polygon_mesh_processing;
+    Surface_mesh object(mesh), cell(makeSurfaceMesh(placeCutter(cutter))), intersection;
+    if(!PMP::corefine_and_compute_intersection(object, cell, intersection))
+    {
+        throw std::runtime_error("corefinement result is not manifold");
+    }
+    for(auto v : intersection.vertices())
+    {
+        CGAL::exact(intersection.point(v));
     }
+    return intersection;
+#else
+    throw std::runtime_error("corefinement needs CGAL 5.1");
+#endif
+}
 
-    builder B(hds,true);
-    B.begin_surface(3,1,6);
+std::vector<gg::MeshManipulators::Surface_mesh>
+    gg::MeshManipulators::splitPolyhedron(gg::MeshManipulators::Surface_mesh mesh)
+{
+#if GG_COREFINEMENT
+    std::vector<Surface_mesh> parts;
+    CGAL::Polygon_mesh_processing::split_connected_components(mesh, parts);
+    return parts;
+#else
+    throw std::runtime_error("corefinement needs CGAL 5.1");
+#endif
+}
+
+void gg::MeshManipulators::TriangleMeshBuilder::operator()(gg::MeshManipulators::HalfedgeDS &hds)
+{
+    CGAL::Polyhedron_incremental_builder_3<HalfedgeDS> B(hds, true);
+    typedef typename HalfedgeDS::Vertex Vertex;
+    typedef typename Vertex::Point Point;
 
-    // add vertices
-    std::list<Vertex_handle>::iterator vit;
-    for(vit = ordered_vertices.begin();
-        vit != ordered_vertices.end();
-        vit++)
+    //a polyhedron has no isolated vertices, those no triangle uses are left out
+    std::vector<uint32_t> remap(m_mesh.vertexCount(), UINT32_MAX);
+    for(auto &&index : m_mesh.indices)
+    {
+        remap[index] = 0;
+    }
+    uint32_t used = 0;
+    for(auto &&index : remap)
     {
-        Vertex_handle v = *vit;
-        B.add_vertex(v->point());
+        if(index == 0)
+        {
+            index = used++;
+        }
     }
+    B.begin_surface(used, m_mesh.triangleCount());
+    for(size_t i = 0; i < m_mesh.vertexCount(); i++)
+    {
+        if(remap[i] != UINT32_MAX)
+        {
+            B.add_vertex(Point(m_mesh.vertices[i * 3], m_mesh.vertices[i * 3 + 1], m_mesh.vertices[i * 3 + 2]));
+        }
+    }
+    for(size_t i = 0; i < m_mesh.indices.size(); i += 3)
+    {
+        B.begin_facet();
+        B.add_vertex_to_facet(remap[m_mesh.indices[i]]);
+        B.add_vertex_to_facet(remap[m_mesh.indices[i + 1]]);
+        B.add_vertex_to_facet(remap[m_mesh.indices[i + 2]]);
+        B.end_facet();
+    }
+    B.end_surface();
+}
 
-    // add facets
-    Faces::iterator fit;
-    for(fit = faces.begin();
-        fit != faces.end();
-        fit++)
+void gg::MeshManipulators::PolygonMeshBuilder::operator()(gg::MeshManipulators::HalfedgeDS &hds)
+{
+    CGAL::Polyhedron_incremental_builder_3<HalfedgeDS> B(hds, true);
+    B.begin_surface(m_mesh.points.size(), m_mesh.faceCount);
+    for(auto &&point : m_mesh.points)
+    {
+        B.add_vertex(point);
+    }
+    for(size_t i = 0; i < m_mesh.faces.size(); i += m_mesh.faces[i] + 1)
     {
-        Face_handle f = *fit;
         B.begin_facet();
-        F_circulator he = f->facet_begin();
-        F_circulator end = he;
-        CGAL_For_all(he,end)
+        for(uint32_t j = 1; j <= m_mesh.faces[i]; j++)
         {
-            Vertex_handle v = he->vertex();
-            B.add_vertex_to_facet(vertex_map[v]);
+            B.add_vertex_to_facet(m_mesh.faces[i + j]);
         }
         B.end_facet();
     }
@@ -15,17 +15,31 @@
 #include <btBulletDynamicsCommon.h>
 
 #include <CGAL/Polyhedron_3.h>
+#include <CGAL/Polyhedron_items_with_id_3.h>
 #include <CGAL/Polyhedron_incremental_builder_3.h>
 #include <CGAL/Nef_polyhedron_3.h>
 #include <CGAL/Exact_predicates_exact_constructions_kernel.h>
 #include <CGAL/convex_decomposition_3.h>
+#include <CGAL/Surface_mesh.h>
+#include <CGAL/version.h>
 
 #include <voro++/voro++.hh>
 #include <btHACDCompoundShape.h>
 
+#include "TriangleMesh.h"
+
 #include <chrono>
+#include <memory>
 #include <vector>
 
+//the corefinement backend uses Polygon_mesh_processing from CGAL 5.1 (split_connected_components),
+//with older versions its operations throw and every cut goes to the Nef polyhedra
+#if CGAL_VERSION_NR >= 1050101000
+#define GG_COREFINEMENT 1
+#else
+#define GG_COREFINEMENT 0
+#endif
+
 using namespace irr;
 using namespace core;
 using namespace scene;
@@ -40,8 +54,33 @@ namespace gg
     public:
         typedef CGAL::Exact_predicates_exact_constructions_kernel Kernel;
         typedef CGAL::Polyhedron_3<Kernel> Polyhedron;
+        //vertices and facets numbered densely, for the splitter
+        typedef CGAL::Polyhedron_3<Kernel, CGAL::Polyhedron_items_with_id_3> Indexed_polyhedron;
         typedef Polyhedron::HalfedgeDS HalfedgeDS;
         typedef CGAL::Nef_polyhedron_3<Kernel, CGAL::SNC_indexed_items> Nef_polyhedron;
+        typedef CGAL::Surface_mesh<Kernel::Point_3> Surface_mesh;
+        //cell shared by the impacts, its position in the space of the cut polyhedron, its rotation and scale,
+        //and the cells that partition it when the impact shatters the object (null otherwise)
+        typedef std::tuple<std::shared_ptr<const MTriangleMesh>, irr::core::vector3df, irr::core::matrix4,
+                           std::shared_ptr<const std::vector<MTriangleMesh>>> Cutter;
+
+        //buffer of standard vertices with room for the counts, its indices are 16-bit when they are enough
+        //and 32-bit for larger meshes
+        static irr::scene::CDynamicMeshBuffer *createMeshBuffer(irr::u32 vertexCount, irr::u32 indexCount);
+
+        //calls visit with a pointer to the indices of the buffer, u16 or u32 depending on their width
+        template<class F>
+        static void visitIndices(irr::scene::IMeshBuffer *buffer, F &&visit)
+        {
+            if(buffer->getIndexType() == irr::video::EIT_32BIT)
+            {
+                visit(reinterpret_cast<const irr::u32 *>(buffer->getIndices()));
+            }
+            else
+            {
+                visit(static_cast<const irr::u16 *>(buffer->getIndices()));
+            }
+        }
 
         static std::tuple<irr::scene::IMesh *, irr::core::vector3df> convertPolyToMesh(Nef_polyhedron &poly);
 
@@ -51,77 +90,105 @@ namespace gg
 
         static btCollisionShape *nefToShape(Nef_polyhedron &poly);
 
-        static irr::scene::IMesh *convertMesh(voro::voronoicell &cell);
+        static std::tuple<Nef_polyhedron, Nef_polyhedron> subtractMesh(Nef_polyhedron &nef, const Cutter &cutter);
+
+        //cuts all cutters out of nef at once, the cutters are joined first, so nef goes through two
+        //boolean operations (difference and intersection) however many cutters there are
+        static std::tuple<Nef_polyhedron, Nef_polyhedron> subtractMesh(Nef_polyhedron &nef, const std::vector<Cutter> &cutters);
 
-        static std::tuple<Nef_polyhedron, Nef_polyhedron> subtractMesh(Nef_polyhedron &nef, irr::scene::IMesh *what, irr::core::vector3df position);
+        //part of nef inside the cutter, one overlay
+        static Nef_polyhedron intersectMesh(const Nef_polyhedron &nef, const Cutter &cutter);
+
+        //parts of nef in the cells of a shattering cutter, one overlay: the walls of the cells are taken
+        //out of nef and, as Nef booleans are not regularized, every volume left is a connected part
+        static std::vector<Nef_polyhedron> partitionMesh(const Nef_polyhedron &nef, const Cutter &shatter);
 
         static Nef_polyhedron makeNefPolyhedron(irr::scene::IMesh *);
 
+        //connected parts, found by union-find over the facets of the polyhedron; a polyhedron in one part
+        //is returned as it is, the others are rebuilt from flat arrays of their exact vertices
         static std::vector<Nef_polyhedron> splitPolyhedron(Nef_polyhedron poly);
 
+        //triangulated boundary of the polyhedron, convex facets as fans and the others by Delaunay triangulation
+        static MTriangleMesh convertToTriangleMesh(Nef_polyhedron &poly);
+
+        //the welding stage of meshes loaded from files, corners at the same position share a vertex;
+        //with a positive epsilon the positions are snapped to a grid of that spacing first
+        static MTriangleMesh convertToTriangleMesh(irr::scene::IMesh *mesh,
+                                                   irr::core::vector3df position = irr::core::vector3df(0, 0, 0),
+                                                   double epsilon = 0);
+
+        //render mesh centred on the centre of the bounding box, which is returned with it; the buffer holds
+        //one vertex per mesh vertex and crease, so flat faces are lit flat and fine tessellations smoothly
+        static std::tuple<irr::scene::IMesh *, irr::core::vector3df> convertPolyToMesh(const MTriangleMesh &mesh);
+
+        //cell of the cutter turned, scaled and moved to its position
+        static MTriangleMesh placeCutter(const Cutter &cutter);
+
+        //cell of the particle at x, y, z, faces are triangulated as fans and oriented outwards
+        static MTriangleMesh convertToTriangleMesh(voro::voronoicell &cell, double x, double y, double z);
+
+        static Nef_polyhedron makeNefPolyhedron(const MTriangleMesh &mesh);
+
+        //floating-point subtraction of convex cutters, throws MFastBoolean::Degenerate when the result cannot be trusted
+        static std::tuple<MTriangleMesh, std::vector<MTriangleMesh>> subtractMesh(const MTriangleMesh &mesh,
+                                                                                 const std::vector<Cutter> &cutters);
+
+        static Surface_mesh makeSurfaceMesh(irr::scene::IMesh *mesh,
+                                            irr::core::vector3df position = irr::core::vector3df(0, 0, 0));
+
+        static Surface_mesh makeSurfaceMesh(const MTriangleMesh &mesh);
+
+        static MTriangleMesh convertToTriangleMesh(const Surface_mesh &mesh);
+
+        static std::tuple<irr::scene::IMesh *, irr::core::vector3df> convertPolyToMesh(const Surface_mesh &mesh);
+
+        //one corefinement of the surface with the joined cutters gives both parts,
+        //throws when the corefinement cannot produce closed manifold results
+        static std::tuple<Surface_mesh, Surface_mesh> subtractMesh(const Surface_mesh &mesh,
+                                                                   const std::vector<Cutter> &cutters);
+
+        //part of the surface inside the cutter, throws when the corefinement cannot produce a closed manifold result
+        static Surface_mesh intersectMesh(const Surface_mesh &mesh, const Cutter &cutter);
+
+        static std::vector<Surface_mesh> splitPolyhedron(Surface_mesh mesh);
+
     private:
-        class PolyhedronBuilder : public CGAL::Modifier_base<HalfedgeDS>
+        //triangles meeting at a smaller angle than 30 degrees share the normals of their corners
+        static constexpr irr::f32 CREASE_COSINE = 0.866f;
+
+        class TriangleMeshBuilder : public CGAL::Modifier_base<HalfedgeDS>
         {
         public:
-            PolyhedronBuilder(irr::scene::IMesh *m, irr::core::vector3df pos = irr::core::vector3df(0, 0, 0)) : m_mesh(
-                    m), m_position(pos)
+            TriangleMeshBuilder(const MTriangleMesh &mesh) : m_mesh(mesh)
             {}
 
             void operator()(HalfedgeDS &hds);
 
         private:
-            irr::scene::IMesh *m_mesh;
-            irr::core::vector3df m_position;
+            const MTriangleMesh &m_mesh;
         };
 
-        template<class Handle>
-        class handle_compare
+        //connected part of a polyhedron with exact coordinates, faces are stored as their vertex count
+        //followed by the vertex indices
+        struct PolygonMesh
         {
-        public:
-            bool operator()(const Handle& h1, const Handle& h2) const
-            {
-                return &(*h1) < &(*h2);
-            }
-        };
-
-        class SplitModifier : public CGAL::Modifier_base<HalfedgeDS>
-        {
-        private:
-            typedef typename HalfedgeDS::Face_handle Face_handle;
-            typedef typename HalfedgeDS::Vertex_handle Vertex_handle;
-            typedef typename HalfedgeDS::Halfedge_handle Halfedge_handle;
-            typedef typename Polyhedron::Halfedge_around_facet_circulator F_circulator;
-            typedef typename CGAL::Polyhedron_incremental_builder_3<HalfedgeDS> builder;
-
-            typedef typename std::set<Face_handle, handle_compare<Face_handle> > Faces;
-            typedef typename std::set<Vertex_handle, handle_compare<Vertex_handle> > Vertices;
-            typedef typename std::set<Halfedge_handle, handle_compare<Halfedge_handle> > Halfedges;
-
-            Halfedge_handle m_seed_halfedge;
-            Halfedges& m_halfedges;
-
-
-        public:
-            SplitModifier(Halfedge_handle seed_halfedge, Halfedges& halfedges)
-                    : m_seed_halfedge(seed_halfedge), m_halfedges(halfedges)
-            {
-            }
-            ~SplitModifier() {}
-
-            void operator()( HalfedgeDS& hds);
+            std::vector<Kernel::Point_3> points;
+            std::vector<uint32_t> faces;
+            uint32_t faceCount = 0;
         };
 
-        class PolyhedronSplitter
+        class PolygonMeshBuilder : public CGAL::Modifier_base<HalfedgeDS>
         {
         public:
-            typedef typename Polyhedron::Halfedge_handle Halfedge_handle;
+            PolygonMeshBuilder(const PolygonMesh &mesh) : m_mesh(mesh)
+            {}
 
-            PolyhedronSplitter() {}
-            ~PolyhedronSplitter() {}
+            void operator()(HalfedgeDS &hds);
 
-            std::vector<Nef_polyhedron> run(Polyhedron &polyhedron);
+        private:
+            const PolygonMesh &m_mesh;
         };
-
     };
 
 }
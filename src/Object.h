@@ -3,7 +3,9 @@
 #ifndef OBJECT_H
 #define OBJECT_H
 
+#include "Geometry.h"
 #include "MeshManipulators.h"
+#include "Prefracture.h"
 
 #include <irrlicht.h>
 #include <btBulletCollisionCommon.h>
@@ -17,6 +19,7 @@
 #include <iostream>
 #include <mutex>
 #include <atomic>
+#include <future>
 
 namespace gg
 {
@@ -48,7 +51,6 @@ namespace gg
         typedef CGAL::Exact_predicates_exact_constructions_kernel Kernel;
         typedef CGAL::Polyhedron_3<Kernel> Polyhedron;
         typedef Polyhedron::HalfedgeDS HalfedgeDS;
-        typedef CGAL::Nef_polyhedron_3<Kernel> Nef_polyhedron;
 
     public:
         inline btRigidBody *getRigid()
@@ -81,12 +83,12 @@ namespace gg
         inline bool isMesh()
         { return m_isMesh; }
 
-        inline Nef_polyhedron &getPolyhedron()
-        { return m_polyhedron; }
+        inline MGeometry &getGeometry()
+        { return m_geometry; }
 
-        inline void setPolyhedron(Nef_polyhedron nef)
+        inline void setGeometry(MGeometry geometry)
         {
-            m_polyhedron = std::move(nef);
+            m_geometry = std::move(geometry);
             m_isMesh = true;
         }
 
@@ -99,6 +101,19 @@ namespace gg
             }
         }
 
+        //keeps the shape the rigid body was created with alive while other undamaged instances of the asset share it
+        inline void setSharedShape(std::shared_ptr<btCollisionShape> shape)
+        {
+            m_sharedShape = std::move(shape);
+        }
+
+        //replaces the collision shape of the rigid body, the old one is deleted unless it is shared
+        inline void setCollisionShape(btCollisionShape *shape)
+        {
+            releaseShape();
+            m_rigidBody->setCollisionShape(shape);
+        }
+
         inline const irr::core::quaternion getPolyhedronTransform()
         {
             return m_polyhedronTransformation;
@@ -106,6 +121,11 @@ namespace gg
 
         irr::core::vector3df translation = irr::core::vector3df(0,0,0);
 
+        //chunks the object breaks into, computed in the background while the game runs
+        std::shared_future<std::shared_ptr<const MPrefracture>> prefracture;
+        //hulls of the chunks in the compound shape of the object, nullptr once detached, main thread only
+        std::vector<btCollisionShape *> chunkShapes;
+
         ~MObject()
         {
             if(m_rigidBody.get() != nullptr)
@@ -114,10 +134,7 @@ namespace gg
                 {
                     delete m_rigidBody->getMotionState();
                 }
-                if(m_rigidBody->getCollisionShape() != nullptr)
-                {
-                    delete m_rigidBody->getCollisionShape();
-                }
+                releaseShape();
             }
             if(m_irrSceneNode)
             {
@@ -139,8 +156,8 @@ namespace gg
             m_polyhedronTransformation.makeIdentity();
             if(m_isMesh)
             {
-                m_polyhedron = std::move(
-                        MeshManipulators::makeNefPolyhedron(static_cast<irr::scene::IMeshSceneNode *>(sn)->getMesh()));
+                m_geometry = MGeometry(
+                        MeshManipulators::convertToTriangleMesh(static_cast<irr::scene::IMeshSceneNode *>(sn)->getMesh()));
                 m_polyhedronTransformation = sn->getRelativeTransformation();
             }
             version.store(0);
@@ -155,16 +172,16 @@ namespace gg
             m_polyhedronTransformation.makeIdentity();
             if(m_isMesh)
             {
-                m_polyhedron = std::move(
-                        MeshManipulators::makeNefPolyhedron(static_cast<irr::scene::IMeshSceneNode *>(sn)->getMesh()));
+                m_geometry = MGeometry(
+                        MeshManipulators::convertToTriangleMesh(static_cast<irr::scene::IMeshSceneNode *>(sn)->getMesh()));
                 m_polyhedronTransformation = sn->getRelativeTransformation();
             }
             version.store(0);
             reference_count.store(0);
         }
 
-        MObject(btRigidBody *rb, irr::scene::ISceneNode *sn, Type type, Nef_polyhedron &&nef) : m_rigidBody(
-                std::unique_ptr<btRigidBody>(rb)), m_irrSceneNode(sn), m_type(type), m_polyhedron(nef)
+        MObject(btRigidBody *rb, irr::scene::ISceneNode *sn, Type type, MGeometry &&geometry) : m_rigidBody(
+                std::unique_ptr<btRigidBody>(rb)), m_irrSceneNode(sn), m_type(type), m_geometry(std::move(geometry))
         {
             m_empty = m_rigidBody == nullptr;
             m_deleted = false;
@@ -177,10 +194,11 @@ namespace gg
         MObject(MObject &&other)
         {
             m_rigidBody = std::move(other.m_rigidBody);
+            m_sharedShape = std::move(other.m_sharedShape);
             m_irrSceneNode = other.m_irrSceneNode;
             m_type = other.m_type;
             m_deleted = other.m_deleted;
-            m_polyhedron = std::move(other.m_polyhedron);
+            m_geometry = std::move(other.m_geometry);
             m_polyhedronTransformation = std::move(other.m_polyhedronTransformation);
             translation = other.translation;
             version.store(0);
@@ -196,12 +214,25 @@ namespace gg
         Timer m_timer;
 
     private:
+        inline void releaseShape()
+        {
+            if(m_rigidBody->getCollisionShape() == m_sharedShape.get())
+            {
+                m_sharedShape.reset();
+            }
+            else
+            {
+                delete m_rigidBody->getCollisionShape();
+            }
+        }
+
         std::unique_ptr<btRigidBody> m_rigidBody;
+        std::shared_ptr<btCollisionShape> m_sharedShape;
         irr::scene::ISceneNode *m_irrSceneNode;
         bool m_empty, m_deleted = false;
         Type m_type;
         bool m_isMesh = false;
-        Nef_polyhedron m_polyhedron;
+        MGeometry m_geometry;
         irr::core::quaternion m_polyhedronTransformation;
     };
 
@@ -11,6 +11,36 @@ gg::MObjectCreator::MObjectCreator(IrrlichtDevice *irr) : m_irrDevice(irr)
 {
 }
 
+gg::MObjectCreator::~MObjectCreator()
+{
+    for(auto &&asset : m_assets)
+    {
+        asset.second.mesh->drop();
+    }
+}
+
+gg::MObjectCreator::Asset gg::MObjectCreator::loadAsset(const std::string &file, const vector3df &scale)
+{
+    IMesh *mesh_orig = m_irrDevice->getSceneManager()->getMesh((m_media + file).c_str());
+    IMesh *mesh = m_irrDevice->getSceneManager()->getMeshManipulator()->createMeshUniquePrimitives(mesh_orig);
+    m_irrDevice->getSceneManager()->getMeshManipulator()->scale(mesh, scale);
+
+    Asset asset;
+    asset.triangles = std::make_shared<const MTriangleMesh>(MeshManipulators::convertToTriangleMesh(mesh));
+    mesh->drop();
+    //make colorfull mesh
+    std::tie(asset.mesh, asset.center) = MeshManipulators::convertPolyToMesh(*asset.triangles);
+
+    // Create the shape
+    btCollisionShape *triangles = MeshManipulators::convertMesh(asset.mesh);
+    asset.shape.reset(new btHACDCompoundShape(triangles));
+    asset.shape->setMargin(0.01f);
+    //the compound keeps only the convex hulls, the triangle shape it was built from is not needed anymore
+    delete static_cast<btBvhTriangleMeshShape *>(triangles)->getMeshInterface();
+    delete triangles;
+    return asset;
+}
+
 std::unique_ptr<gg::MObject> gg::MObjectCreator::createMeshRigidBody(std::vector<std::string> &&items)
 {
     if(items.size() != 9)
@@ -30,18 +60,16 @@ std::unique_ptr<gg::MObject> gg::MObjectCreator::createMeshRigidBody(std::vector
     core::vector3df scale(numbers[3], numbers[4], numbers[5]);
     const btScalar Mass = numbers[6];
 
-    IMesh *mesh_orig = m_irrDevice->getSceneManager()->getMesh((m_media + input).c_str());
-    IMesh *mesh = m_irrDevice->getSceneManager()->getMeshManipulator()->createMeshUniquePrimitives(mesh_orig);
-
-    IMeshSceneNode *Node = m_irrDevice->getSceneManager()->addMeshSceneNode(mesh);
-    m_irrDevice->getSceneManager()->getMeshManipulator()->scale(mesh, scale);
-
-    MeshManipulators::Nef_polyhedron polyhedron = std::move(MeshManipulators::makeNefPolyhedron(mesh));
+    //instances of one file at one scale share their meshes and shape until they are damaged
+    std::string key(input + ";" + items[5] + ";" + items[6] + ";" + items[7]);
+    auto asset = m_assets.find(key);
+    if(asset == m_assets.end())
+    {
+        asset = m_assets.insert(std::make_pair(key, loadAsset(input, scale))).first;
+    }
+    vector3df center(asset->second.center);
 
-    vector3df center;
-    //make colorfull mesh
-    std::tie(mesh, center) = MeshManipulators::convertPolyToMesh(polyhedron);
-    Node->setMesh(mesh);
+    IMeshSceneNode *Node = m_irrDevice->getSceneManager()->addMeshSceneNode(asset->second.mesh);
     Node->setMaterialType(EMT_SOLID);
     Node->setMaterialFlag(EMF_LIGHTING, 1);
     Node->setMaterialFlag(EMF_NORMALIZE_NORMALS, true);
@@ -54,9 +82,7 @@ std::unique_ptr<gg::MObject> gg::MObjectCreator::createMeshRigidBody(std::vector
 
     btDefaultMotionState *motionState = new btDefaultMotionState(Transform);
 
-    // Create the shape
-    btCollisionShape *Shape = new btHACDCompoundShape(MeshManipulators::convertMesh(Node));
-    Shape->setMargin(0.01f);
+    btCollisionShape *Shape = asset->second.shape.get();
 
     // Add mass
     btVector3 localInertia;
@@ -67,7 +93,11 @@ std::unique_ptr<gg::MObject> gg::MObjectCreator::createMeshRigidBody(std::vector
 
     MObject::Type type = MObject::Type::BUILDING;
 
-    std::unique_ptr<gg::MObject> obj(new MObject(rigidBody, Node, type, std::move(polyhedron)));
+    //the Nef polyhedron is built when the object is cut for the first time, or prefetched when a shot aims at it
+    std::unique_ptr<gg::MObject> obj(new MObject(rigidBody, Node, type, MGeometry(asset->second.triangles)));
+    obj->setSharedShape(asset->second.shape);
+    //the polyhedron keeps the coordinates of the file, the node is centred on center
+    obj->translation = center;
     // Store a pointer to the irrlicht node so we can update it later
     rigidBody->setUserPointer((void *) (obj.get()));
 
@@ -226,7 +256,7 @@ std::unique_ptr<gg::MObject> gg::MObjectCreator::shoot(btVector3 position, btVec
 
 std::unique_ptr<gg::MObject> gg::MObjectCreator::createMeshRigidBodyWithTmpShape(IMesh* mesh, btVector3 position, btScalar mass,
                                                      gg::MObject::Type type,
-                                                     gg::MeshManipulators::Nef_polyhedron &&poly)
+                                                     gg::MGeometry &&geometry)
 {
     IMeshSceneNode *Node = m_irrDevice->getSceneManager()->addMeshSceneNode(mesh);
     Node->setPosition(vector3df(position.getX(), position.getY(), position.getZ()));
@@ -248,7 +278,7 @@ std::unique_ptr<gg::MObject> gg::MObjectCreator::createMeshRigidBodyWithTmpShape
 
     btRigidBody *rigidBody = new btRigidBody(mass, motionState, Shape, localInertia);
 
-    std::unique_ptr<MObject> fragment(new MObject(rigidBody, Node, type, std::move(poly)));
+    std::unique_ptr<MObject> fragment(new MObject(rigidBody, Node, type, std::move(geometry)));
     rigidBody->setUserPointer((void *) (fragment.get()));
 
     return std::move(fragment);
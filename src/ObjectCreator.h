@@ -16,6 +16,7 @@
 #include <LinearMath/btQuaternion.h>
 #include <btHACDCompoundShape.h>
 
+#include <map>
 #include <string>
 #include <vector>
 #include <memory>
@@ -28,6 +29,8 @@ namespace gg
     public:
         MObjectCreator(irr::IrrlichtDevice *);
 
+        ~MObjectCreator();
+
         std::unique_ptr<MObject> createMeshRigidBody(std::vector<std::string> &&);
 
         std::unique_ptr<MObject> createBoxedRigidBody(std::vector<std::string> &&);
@@ -38,11 +41,23 @@ namespace gg
 
         std::unique_ptr<MObject> createMeshRigidBodyWithTmpShape(irr::scene::IMesh *mesh, btVector3 position,
                                      btScalar mass, MObject::Type type,
-                                     MeshManipulators::Nef_polyhedron &&poly);
+                                     MGeometry &&geometry);
 
     private:
+        //what the instances of one mesh file at one scale share until each of them is damaged
+        struct Asset
+        {
+            std::shared_ptr<const MTriangleMesh> triangles;
+            irr::scene::IMesh *mesh = nullptr; //render mesh centred on center
+            irr::core::vector3df center;
+            std::shared_ptr<btCollisionShape> shape;
+        };
+
+        Asset loadAsset(const std::string &file, const irr::core::vector3df &scale);
+
         irr::IrrlichtDevice *m_irrDevice;
         const std::string m_media = "media/";
+        std::map<std::string, Asset> m_assets; //by file and scale
     };
 
 }
@@ -0,0 +1,130 @@
+#include "Prefracture.h"
+#include "FastBoolean.h"
+#include "MeshManipulators.h"
+
+#include <LinearMath/btConvexHullComputer.h>
+#include <CGAL/FPU.h>
+#include <voro++/voro++.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+std::shared_ptr<const gg::MPrefracture> gg::MPrefracture::compute(const MTriangleMesh &mesh, unsigned count, unsigned seed)
+{
+    //runs on a thread of its own, the Nef fallback expects round to nearest
+    CGAL::FPU_set_cw(CGAL_FE_TONEAREST);
+    std::shared_ptr<MPrefracture> prefracture(std::make_shared<MPrefracture>());
+    if(mesh.empty() || count == 0)
+    {
+        return prefracture;
+    }
+
+    double min[3], max[3];
+    std::copy(mesh.vertices.begin(), mesh.vertices.begin() + 3, min);
+    std::copy(mesh.vertices.begin(), mesh.vertices.begin() + 3, max);
+    for(size_t i = 0; i < mesh.vertices.size(); i++)
+    {
+        min[i % 3] = std::min(min[i % 3], mesh.vertices[i]);
+        max[i % 3] = std::max(max[i % 3], mesh.vertices[i]);
+    }
+    //the walls of the container must not touch the surface of the object
+    for(int i = 0; i < 3; i++)
+    {
+        double margin = (max[i] - min[i]) * 0.01 + 0.01;
+        min[i] -= margin;
+        max[i] += margin;
+    }
+
+    //about five seeds per block of the container
+    int blocks = std::max(1, static_cast<int>(std::cbrt(count / 5.0)));
+    voro::container con(min[0], max[0], min[1], max[1], min[2], max[2],
+                        blocks, blocks, blocks,
+                        false, false, false,
+                        8);
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<double> unit(0, 1);
+    for(unsigned i = 0; i < count; i++)
+    {
+        double x = min[0] + unit(random) * (max[0] - min[0]);
+        double y = min[1] + unit(random) * (max[1] - min[1]);
+        double z = min[2] + unit(random) * (max[2] - min[2]);
+        con.put(i, x, y, z);
+    }
+
+    MeshManipulators::Nef_polyhedron nef;
+    bool hasNef = false;
+    voro::c_loop_all loop(con);
+    voro::voronoicell cell;
+    if(loop.start())
+    {
+        do
+        {
+            if(!con.compute_cell(cell, loop))
+            {
+                continue;
+            }
+            double x, y, z;
+            loop.pos(x, y, z);
+            MTriangleMesh cutter(MeshManipulators::convertToTriangleMesh(cell, x, y, z));
+            MTriangleMesh piece;
+            try
+            {
+                std::tie(std::ignore, piece) = MFastBoolean::subtract(mesh, cutter);
+            }
+            catch(MFastBoolean::Degenerate &)
+            {
+                if(!hasNef)
+                {
+                    nef = MeshManipulators::makeNefPolyhedron(mesh);
+                    hasNef = true;
+                }
+                MeshManipulators::Nef_polyhedron part(nef * MeshManipulators::makeNefPolyhedron(cutter));
+                piece = MeshManipulators::convertToTriangleMesh(part);
+            }
+            //a cell can cut off separate parts of a concave object, each of them falls on its own
+            for(auto &&component : piece.components())
+            {
+                prefracture->addChunk(std::move(component));
+            }
+        } while(loop.inc());
+    }
+    return prefracture;
+}
+
+gg::MPrefracture::~MPrefracture()
+{
+    for(auto &&chunk : m_chunks)
+    {
+        chunk.render->drop();
+    }
+}
+
+void gg::MPrefracture::addChunk(MTriangleMesh &&mesh)
+{
+    Chunk chunk;
+    std::tie(chunk.render, chunk.center) = MeshManipulators::convertPolyToMesh(mesh);
+    if(!chunk.render)
+    {
+        return;
+    }
+
+    std::vector<btScalar> points(mesh.vertices.begin(), mesh.vertices.end());
+    btConvexHullComputer hull;
+    hull.compute(points.data(), 3 * sizeof(btScalar), static_cast<int>(mesh.vertexCount()), 0, 0);
+    btVector3 center(chunk.center.X, chunk.center.Y, chunk.center.Z);
+    for(int i = 0; i < hull.vertices.size(); i++)
+    {
+        chunk.hull.push_back(hull.vertices[i] - center);
+    }
+    chunk.mesh = std::move(mesh);
+    m_chunks.push_back(std::move(chunk));
+}
+
+gg::MChunkShape::~MChunkShape()
+{
+    for(int i = 0; i < getNumChildShapes(); i++)
+    {
+        delete getChildShape(i);
+    }
+}
@@ -0,0 +1,63 @@
+/*
+ * Voronoi pattern an object is broken into, computed once per asset when the level is loaded.
+ * The chunks are the intersections of the object with the cells of random seeds in its bounding box,
+ * each with its render mesh and convex hull, so an impact only has to detach the chunks near the hit
+ * instead of running a boolean operation. The pattern is shared by every object built from the same asset.
+ */
+
+#ifndef PREFRACTURE_H
+#define PREFRACTURE_H
+
+#include "TriangleMesh.h"
+
+#include <irrlicht.h>
+#include <btBulletCollisionCommon.h>
+
+#include <memory>
+#include <vector>
+
+namespace gg
+{
+
+    class MPrefracture
+    {
+    public:
+        struct Chunk
+        {
+            MTriangleMesh mesh; //in the space of the polyhedron of the object
+            irr::scene::IMesh *render = nullptr; //centred on center
+            irr::core::vector3df center;
+            std::vector<btVector3> hull; //convex hull of the chunk, relative to center
+        };
+
+        //breaks the closed mesh into at most count chunks, the same seed gives the same pattern,
+        //throws when CGAL fails on a cell that the fast booleans refused
+        static std::shared_ptr<const MPrefracture> compute(const MTriangleMesh &mesh, unsigned count, unsigned seed);
+
+        inline const std::vector<Chunk> &chunks() const
+        { return m_chunks; }
+
+        MPrefracture() = default;
+
+        MPrefracture(const MPrefracture &) = delete;
+
+        MPrefracture &operator=(const MPrefracture &) = delete;
+
+        ~MPrefracture();
+
+    private:
+        void addChunk(MTriangleMesh &&mesh);
+
+        std::vector<Chunk> m_chunks;
+    };
+
+    //compound of the chunks still attached to an object, owns their hulls
+    class MChunkShape : public btCompoundShape
+    {
+    public:
+        ~MChunkShape();
+    };
+
+}
+
+#endif // PREFRACTURE_H
@@ -0,0 +1,104 @@
+#include "Script.h"
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+
+using namespace irr;
+using namespace core;
+
+bool gg::MScript::load(std::string file)
+{
+    std::fstream fin;
+    fin.open(file, std::fstream::in);
+    if(!fin.is_open())
+    {
+        std::cerr << "Script " << file << " could not be opened\n";
+        return false;
+    }
+
+    m_poses.clear();
+    m_shots.clear();
+    std::string current_line;
+    int line = 0;
+    while(std::getline(fin, current_line))
+    {
+        line++;
+        if(current_line == "" || current_line[0] == '#')
+        {
+            continue;
+        }
+        std::vector<std::string> items(split(std::stringstream(current_line)));
+        try
+        {
+            if(items[0] == "world" && items.size() == 2)
+            {
+                m_world = items[1];
+            }
+            else if(items[0] == "frames" && items.size() == 3)
+            {
+                m_frames = std::stoul(items[1]);
+                m_timeStep = std::stoul(items[2]);
+            }
+            else if(items[0] == "pose" && items.size() == 8)
+            {
+                Pose pose;
+                pose.frame = std::stoul(items[1]);
+                pose.position = btVector3(std::stof(items[2]), std::stof(items[3]), std::stof(items[4]));
+                //yaw is the rotation around y, pitch around x and roll around z
+                pose.rotation = btQuaternion(std::stof(items[6]) * DEGTORAD, std::stof(items[5]) * DEGTORAD,
+                                             std::stof(items[7]) * DEGTORAD);
+                m_poses.push_back(pose);
+            }
+            else if(items[0] == "shot" && items.size() == 2)
+            {
+                m_shots.insert(std::stoul(items[1]));
+            }
+            else
+            {
+                std::cerr << "Script " << file << ":" << line << ": unknown command\n";
+                return false;
+            }
+        }
+        catch(std::logic_error &)
+        {
+            std::cerr << "Script " << file << ":" << line << ": wrong parameter\n";
+            return false;
+        }
+    }
+    fin.close();
+
+    std::stable_sort(m_poses.begin(), m_poses.end(), [](const Pose &a, const Pose &b) { return a.frame < b.frame; });
+    return true;
+}
+
+btTransform gg::MScript::getPose(u32 frame) const
+{
+    auto next = std::find_if(m_poses.begin(), m_poses.end(), [frame](const Pose &p) { return p.frame > frame; });
+    if(next == m_poses.begin())
+    {
+        return btTransform(next->rotation, next->position);
+    }
+    auto previous = next - 1;
+    if(next == m_poses.end())
+    {
+        return btTransform(previous->rotation, previous->position);
+    }
+
+    //interpolate between the two surrounding keyframes
+    btScalar t = btScalar(frame - previous->frame) / btScalar(next->frame - previous->frame);
+    return btTransform(previous->rotation.slerp(next->rotation, t), previous->position.lerp(next->position, t));
+}
+
+bool gg::MScript::isShot(u32 frame) const
+{
+    return m_shots.count(frame) > 0;
+}
+
+std::vector<std::string> gg::MScript::split(std::stringstream &&input)
+{
+    std::vector<std::string> parts;
+    for(std::string item; std::getline(input, item, ';'); parts.push_back(item))
+    {
+    }
+    return std::move(parts);
+}
@@ -0,0 +1,66 @@
+/* drives the ship when the application runs headless.
+ * The script is a text file in the same ';' separated format as media/world.cfg:
+ *
+ *   world;media/world.cfg             level to load
+ *   frames;1200;16                    number of simulated frames and the fixed time step in ms
+ *   pose;0;0;20;0;0;33.7;0            frame;position x;y;z;rotation x;y;z (degrees)
+ *   shot;30                           frame in which the ship fires
+ *
+ * Poses are keyframes, the ship is interpolated between them. Lines starting with '#' are ignored.
+ */
+
+#ifndef SCRIPT_H
+#define SCRIPT_H
+
+#include <irrlicht.h>
+#include <btBulletDynamicsCommon.h>
+
+#include <string>
+#include <vector>
+#include <set>
+#include <sstream>
+
+namespace gg
+{
+
+    class MScript
+    {
+    public:
+        bool load(std::string);
+
+        inline const std::string &getWorld() const
+        { return m_world; }
+
+        inline irr::u32 getFrames() const
+        { return m_frames; }
+
+        inline irr::u32 getTimeStep() const
+        { return m_timeStep; }
+
+        inline bool hasPoses() const
+        { return !m_poses.empty(); }
+
+        btTransform getPose(irr::u32 frame) const;
+
+        bool isShot(irr::u32 frame) const;
+
+    private:
+        struct Pose
+        {
+            irr::u32 frame;
+            btVector3 position;
+            btQuaternion rotation;
+        };
+
+        std::vector<std::string> split(std::stringstream &&);
+
+        std::string m_world = "media/world.cfg";
+        irr::u32 m_frames = 600;
+        irr::u32 m_timeStep = 16;
+        std::vector<Pose> m_poses;
+        std::set<irr::u32> m_shots;
+    };
+
+}
+
+#endif // SCRIPT_H
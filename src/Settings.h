@@ -0,0 +1,65 @@
+/*
+ * holds the configuration of one run of the application.
+ * The values are filled from the command line in main.cpp and handed over
+ * to gg::MGame, which passes the relevant parts to the other modules.
+ */
+
+#ifndef SETTINGS_H
+#define SETTINGS_H
+
+#include <string>
+
+namespace gg
+{
+
+    struct MSettings
+    {
+        //draw bullet debug geometry
+        bool debug = false;
+
+        //run without a window, driven by the script instead of the keyboard
+        bool headless = false;
+        std::string script;
+
+        //seconds between two telemetry snapshots written to data/telemetry.{csv,json}, 0 disables them
+        double telemetryInterval = 5;
+
+        //file the Chrome trace of the run is written to, empty when tracing is disabled
+        std::string trace;
+
+        //threads cutting meshes, 0 uses one per hardware thread
+        unsigned subtractionWorkers = 0;
+
+        //threads running HACD on new meshes, 0 uses one per hardware thread
+        unsigned decompositionWorkers = 0;
+
+        //milliseconds of a frame the main thread spends applying results of the workers, 0 applies all of them
+        double applyBudget = 2;
+
+        //outstanding tasks of all stages, from the impacts being cut to the pieces waiting for decomposition,
+        //above which impacts are cut by plain cubes, 0 disables; meshes are decomposed with faster
+        //HACD settings once as many wait for the decomposition stage
+        unsigned softLimit = 16;
+
+        //outstanding tasks above which the weakest impacts are dropped, 0 disables
+        unsigned hardLimit = 64;
+
+        //boolean operations of the cuts: exact on Nef polyhedra, in floating point on triangle meshes,
+        //or exact corefinement of surface meshes; the latter two repeat a cut they cannot handle on Nef polyhedra
+        enum class Boolean
+        {
+            NEF, FAST, COREFINEMENT
+        };
+        Boolean boolean = Boolean::NEF;
+
+        //Voronoi cells an impact shatters the hit region into, 0 cuts off a single piece
+        unsigned shatterCells = 0;
+
+        //seed of the cutter library, 0 seeds it from the clock, or with 1 in headless runs
+        //so that a script cuts with the same cells every time
+        unsigned seed = 0;
+    };
+
+}
+
+#endif // SETTINGS_H
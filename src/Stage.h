@@ -0,0 +1,132 @@
+/*
+ * one stage of the fracture pipeline: a queue of tasks served by a pool of worker threads.
+ * Stages are chained by pushing the output of one stage into the next one, so a task
+ * moves on as soon as it is done instead of waiting for the rest of its batch.
+ * Every worker owns a State, constructed on the worker thread before its first task,
+ * which keeps per-thread resources such as allocators or floating-point settings.
+ */
+
+#ifndef STAGE_H
+#define STAGE_H
+
+#include "Trace.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace gg
+{
+
+    struct MNoState
+    {
+    };
+
+    template<class Task, class State = MNoState>
+    class MStage
+    {
+    public:
+        typedef std::function<void(Task &, State &)> Work;
+
+        //name is used for the worker threads in the trace
+        MStage(const char *name, unsigned workers, Work work) : m_name(name), m_work(std::move(work))
+        {
+            for(unsigned i = 0; i < std::max(workers, 1u); i++)
+            {
+                m_workers.push_back(std::thread([this] { run(); }));
+            }
+        }
+
+        MStage(const MStage &) = delete;
+
+        MStage &operator=(const MStage &) = delete;
+
+        ~MStage()
+        {
+            stop();
+        }
+
+        void push(Task &&task)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_tasks.push(std::move(task));
+            m_condVar.notify_one();
+        }
+
+        //number of tasks waiting for a worker
+        size_t size()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_tasks.size();
+        }
+
+        //true when no task is waiting and no worker is busy
+        bool idle()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_tasks.empty() && m_running == 0;
+        }
+
+        //joins the workers, tasks still waiting are destroyed without being run,
+        //so they must release what they hold in their destructors
+        void stop()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_done = true;
+            }
+            m_condVar.notify_all();
+            for(auto &&worker : m_workers)
+            {
+                if(worker.joinable())
+                {
+                    worker.join();
+                }
+            }
+            std::queue<Task> dropped;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                std::swap(dropped, m_tasks);
+            }
+        }
+
+    private:
+        void run()
+        {
+            MTrace::nameThread(m_name);
+            State state;
+            while(true)
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_condVar.wait(lock, [this]() { return !m_tasks.empty() || m_done; });
+                if(m_done)
+                {
+                    return;
+                }
+                Task task(std::move(m_tasks.front()));
+                m_tasks.pop();
+                m_running++;
+                lock.unlock();
+                m_work(task, state);
+                lock.lock();
+                m_running--;
+            }
+        }
+
+        const char *m_name;
+        Work m_work;
+        std::queue<Task> m_tasks;
+        std::mutex m_mutex;
+        std::condition_variable m_condVar;
+        bool m_done = false;
+        unsigned m_running = 0; //workers inside m_work
+        std::vector<std::thread> m_workers;
+    };
+
+}
+
+#endif // STAGE_H
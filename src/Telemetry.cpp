@@ -0,0 +1,309 @@
+#include "Telemetry.h"
+#include <fstream>
+#include <iomanip>
+
+gg::MHistogram::MHistogram()
+{
+    for(auto &&count : m_counts)
+    {
+        count.store(0, std::memory_order_relaxed);
+    }
+    m_sum.store(0, std::memory_order_relaxed);
+}
+
+int gg::MHistogram::bucketOf(uint64_t value)
+{
+    const uint64_t sub_count = 1 << SUB_BUCKET_BITS;
+    if(value < sub_count)
+    {
+        return static_cast<int>(value);
+    }
+    int msb = 63 - __builtin_clzll(value);
+    int shift = msb - SUB_BUCKET_BITS;
+    return ((shift + 1) << SUB_BUCKET_BITS) + static_cast<int>((value >> shift) & (sub_count - 1));
+}
+
+uint64_t gg::MHistogram::lowestValueOf(int bucket)
+{
+    const int sub_count = 1 << SUB_BUCKET_BITS;
+    int magnitude = bucket >> SUB_BUCKET_BITS;
+    uint64_t sub = bucket & (sub_count - 1);
+    if(magnitude == 0)
+    {
+        return sub;
+    }
+    return (sub_count + sub) << (magnitude - 1);
+}
+
+uint64_t gg::MHistogram::highestValueOf(int bucket)
+{
+    int magnitude = bucket >> SUB_BUCKET_BITS;
+    if(magnitude <= 1)
+    {
+        return lowestValueOf(bucket);
+    }
+    return lowestValueOf(bucket) + (uint64_t(1) << (magnitude - 1)) - 1;
+}
+
+void gg::MHistogram::addTo(std::vector<uint64_t> &counts, uint64_t &sum) const
+{
+    counts.resize(BUCKET_COUNT, 0);
+    for(int i = 0; i < BUCKET_COUNT; i++)
+    {
+        counts[i] += m_counts[i].load(std::memory_order_relaxed);
+    }
+    sum += m_sum.load(std::memory_order_relaxed);
+}
+
+namespace
+{
+    std::atomic<unsigned> telemetryInstances {0};
+}
+
+gg::MTelemetry::MTelemetry(std::string path, double interval)
+        : m_id(++telemetryInstances),
+          m_path(path),
+          m_interval(interval),
+          m_start(clock_::now()),
+          m_lastSnapshot(m_start)
+{
+    for(auto &&gauge : m_gauges)
+    {
+        gauge.store(0);
+    }
+}
+
+gg::MTelemetry::ThreadHistograms &gg::MTelemetry::local()
+{
+    //a thread registers once with every registry it records into, keyed by the instance id,
+    //which is never reused even when a new registry is allocated at the address of a destroyed one
+    thread_local std::map<unsigned, ThreadHistograms *> registered;
+    thread_local unsigned lastOwner = 0;
+    thread_local ThreadHistograms *last = nullptr;
+    if(lastOwner == m_id)
+    {
+        return *last;
+    }
+    ThreadHistograms *&histograms = registered[m_id];
+    if(!histograms)
+    {
+        std::lock_guard<std::mutex> lock(m_threadsMutex);
+        m_threads.push_back(std::make_unique<ThreadHistograms>());
+        histograms = m_threads.back().get();
+    }
+    lastOwner = m_id;
+    last = histograms;
+    return *histograms;
+}
+
+void gg::MTelemetry::record(Stage stage, double seconds)
+{
+    if(seconds < 0)
+    {
+        seconds = 0;
+    }
+    local().stages[static_cast<size_t>(stage)].record(static_cast<uint64_t>(seconds * 1e6));
+}
+
+void gg::MTelemetry::label(const void *object, long triangles, long nefVertices, long nefFacets)
+{
+    std::lock_guard<std::mutex> lock(m_labelsMutex);
+    auto found = m_labels.find(object);
+    Label &l = found != m_labels.end() ? found->second : m_labels[object];
+    l.cuts = found != m_labels.end() ? l.cuts + 1 : 1;
+    l.triangles = triangles;
+    l.nefVertices = nefVertices;
+    l.nefFacets = nefFacets;
+}
+
+void gg::MTelemetry::forget(const void *object)
+{
+    std::lock_guard<std::mutex> lock(m_labelsMutex);
+    m_labels.erase(object);
+}
+
+gg::MTelemetry::Summary gg::MTelemetry::summary(Stage stage) const
+{
+    std::vector<uint64_t> counts;
+    uint64_t sum = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_threadsMutex);
+        for(auto &&thread : m_threads)
+        {
+            thread->stages[static_cast<size_t>(stage)].addTo(counts, sum);
+        }
+    }
+
+    Summary s;
+    for(auto &&count : counts)
+    {
+        s.count += count;
+    }
+    if(s.count == 0)
+    {
+        return s;
+    }
+    s.mean = sum * 1e-6 / s.count;
+
+    //walk the buckets once and pick up the percentiles in increasing order
+    const double ranks[] = {0.5, 0.9, 0.99};
+    double *values[] = {&s.p50, &s.p90, &s.p99};
+    size_t next = 0;
+    uint64_t seen = 0;
+    for(int i = 0; i < MHistogram::BUCKET_COUNT; i++)
+    {
+        if(counts[i] == 0)
+        {
+            continue;
+        }
+        seen += counts[i];
+        while(next < 3 && seen >= ranks[next] * s.count)
+        {
+            *values[next] = MHistogram::highestValueOf(i) * 1e-6;
+            next++;
+        }
+        s.max = MHistogram::highestValueOf(i) * 1e-6;
+    }
+    return s;
+}
+
+void gg::MTelemetry::maybeSnapshot()
+{
+    if(m_interval <= 0)
+    {
+        return;
+    }
+    auto now = clock_::now();
+    if(std::chrono::duration<double>(now - m_lastSnapshot).count() >= m_interval)
+    {
+        m_lastSnapshot = now;
+        snapshot();
+    }
+}
+
+void gg::MTelemetry::snapshot()
+{
+    double time = std::chrono::duration<double>(clock_::now() - m_start).count();
+
+    std::ofstream csv(m_path + ".csv", m_csvHeader ? std::ofstream::app : std::ofstream::trunc);
+    if(!m_csvHeader)
+    {
+        csv << "time,stage,count,mean,p50,p90,p99,max\n";
+        m_csvHeader = true;
+    }
+    writeCsv(csv, time);
+
+    std::ofstream json(m_path + ".json", std::ofstream::trunc);
+    writeJson(json, time);
+}
+
+void gg::MTelemetry::writeCsv(std::ostream &os, double time) const
+{
+    for(size_t i = 0; i < static_cast<size_t>(Stage::COUNT); i++)
+    {
+        Summary s = summary(static_cast<Stage>(i));
+        os << time << "," << name(static_cast<Stage>(i)) << "," << s.count << "," << s.mean << "," << s.p50 << ","
+           << s.p90 << "," << s.p99 << "," << s.max << "\n";
+    }
+    for(size_t i = 0; i < static_cast<size_t>(Gauge::COUNT); i++)
+    {
+        os << time << "," << name(static_cast<Gauge>(i)) << "," << gauge(static_cast<Gauge>(i)) << ",,,,,\n";
+    }
+}
+
+void gg::MTelemetry::writeJson(std::ostream &os, double time) const
+{
+    os << "{\n  \"time\": " << time << ",\n  \"stages\": {";
+    for(size_t i = 0; i < static_cast<size_t>(Stage::COUNT); i++)
+    {
+        Summary s = summary(static_cast<Stage>(i));
+        os << (i ? ",\n" : "\n") << "    \"" << name(static_cast<Stage>(i)) << "\": {\"count\": " << s.count
+           << ", \"mean\": " << s.mean << ", \"p50\": " << s.p50 << ", \"p90\": " << s.p90
+           << ", \"p99\": " << s.p99 << ", \"max\": " << s.max << "}";
+    }
+    os << "\n  },\n  \"gauges\": {";
+    for(size_t i = 0; i < static_cast<size_t>(Gauge::COUNT); i++)
+    {
+        os << (i ? ",\n" : "\n") << "    \"" << name(static_cast<Gauge>(i)) << "\": " << gauge(static_cast<Gauge>(i));
+    }
+    os << "\n  },\n  \"objects\": [";
+
+    std::lock_guard<std::mutex> lock(m_labelsMutex);
+    bool first = true;
+    for(auto &&label : m_labels)
+    {
+        os << (first ? "\n" : ",\n") << "    {\"id\": \"" << label.first << "\", \"cuts\": " << label.second.cuts
+           << ", \"triangles\": " << label.second.triangles << ", \"nef_vertices\": " << label.second.nefVertices
+           << ", \"nef_facets\": " << label.second.nefFacets << "}";
+        first = false;
+    }
+    os << "\n  ]\n}\n";
+}
+
+void gg::MTelemetry::printSummary(std::ostream &os, double seconds) const
+{
+    std::ios_base::fmtflags flags(os.flags());
+    std::streamsize precision(os.precision());
+    os << std::left << std::setw(20) << "stage" << std::right << std::setw(8) << "count" << std::setw(10) << "per s"
+       << std::setw(11) << "mean ms" << std::setw(11) << "p50 ms" << std::setw(11) << "p99 ms"
+       << std::setw(11) << "max ms" << "\n";
+    for(size_t i = 0; i < static_cast<size_t>(Stage::COUNT); i++)
+    {
+        Summary s = summary(static_cast<Stage>(i));
+        os << std::left << std::setw(20) << name(static_cast<Stage>(i)) << std::right << std::fixed
+           << std::setprecision(2) << std::setw(8) << s.count << std::setw(10) << s.count / seconds
+           << std::setw(11) << s.mean * 1000 << std::setw(11) << s.p50 * 1000 << std::setw(11) << s.p99 * 1000
+           << std::setw(11) << s.max * 1000 << "\n";
+    }
+    for(size_t i = 0; i < static_cast<size_t>(Gauge::COUNT); i++)
+    {
+        os << std::left << std::setw(20) << name(static_cast<Gauge>(i)) << std::right << std::setw(8)
+           << gauge(static_cast<Gauge>(i)) << "\n";
+    }
+    os.flags(flags);
+    os.precision(precision);
+}
+
+const char *gg::MTelemetry::name(Stage stage)
+{
+    switch(stage)
+    {
+        case Stage::ENQUEUE_WAIT:
+            return "enqueue_wait";
+        case Stage::SUBTRACTION:
+            return "subtraction";
+        case Stage::SPLIT:
+            return "split";
+        case Stage::MESH_CONVERSION:
+            return "mesh_conversion";
+        case Stage::DECOMPOSITION_WAIT:
+            return "decomposition_wait";
+        case Stage::HACD:
+            return "hacd";
+        case Stage::APPLY:
+            return "apply";
+        case Stage::TOTAL:
+            return "impact_to_shape";
+        default:
+            return "unknown";
+    }
+}
+
+const char *gg::MTelemetry::name(Gauge gauge)
+{
+    switch(gauge)
+    {
+        case Gauge::SUBTRACTION_QUEUE:
+            return "subtraction_queue";
+        case Gauge::DECOMPOSITION_QUEUE:
+            return "decomposition_queue";
+        case Gauge::APPLY_BACKLOG:
+            return "apply_backlog";
+        case Gauge::DROPPED_IMPACTS:
+            return "dropped_impacts";
+        case Gauge::NEF_FALLBACKS:
+            return "nef_fallbacks";
+        default:
+            return "unknown";
+    }
+}
@@ -0,0 +1,158 @@
+/*
+ * collects latency measurements of the destruction pipeline.
+ * Every thread records into its own set of histograms, so recording never takes a lock
+ * and threads do not share cache lines. The histograms are log-linear (like HdrHistogram):
+ * every power of two is split into 32 buckets, which keeps the relative error of the
+ * reported percentiles around 3 % for any value from microseconds to hours.
+ * Gauges hold the current value of a quantity such as a queue depth.
+ * Snapshots merge all threads and are written as CSV (appended, one row per stage and gauge)
+ * and JSON (latest state only, including per-object labels).
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace gg
+{
+
+    class MHistogram
+    {
+    public:
+        static const int SUB_BUCKET_BITS = 5;
+        static const int BUCKET_COUNT = (64 - SUB_BUCKET_BITS + 1) << SUB_BUCKET_BITS;
+
+        MHistogram();
+
+        //value in microseconds
+        inline void record(uint64_t value)
+        {
+            m_counts[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+            m_sum.fetch_add(value, std::memory_order_relaxed);
+        }
+
+        void addTo(std::vector<uint64_t> &counts, uint64_t &sum) const;
+
+        static int bucketOf(uint64_t value);
+
+        //smallest value that falls into the bucket
+        static uint64_t lowestValueOf(int bucket);
+
+        //largest value that falls into the bucket
+        static uint64_t highestValueOf(int bucket);
+
+    private:
+        std::array<std::atomic<uint64_t>, BUCKET_COUNT> m_counts;
+        std::atomic<uint64_t> m_sum;
+    };
+
+    class MTelemetry
+    {
+    public:
+        enum class Stage
+        {
+            ENQUEUE_WAIT, SUBTRACTION, SPLIT, MESH_CONVERSION, DECOMPOSITION_WAIT, HACD, APPLY, TOTAL, COUNT
+        };
+
+        enum class Gauge
+        {
+            SUBTRACTION_QUEUE, DECOMPOSITION_QUEUE, APPLY_BACKLOG, DROPPED_IMPACTS, NEF_FALLBACKS, COUNT
+        };
+
+        //percentiles of one stage merged over all threads, in seconds
+        struct Summary
+        {
+            uint64_t count = 0;
+            double mean = 0, p50 = 0, p90 = 0, p99 = 0, max = 0;
+        };
+
+        //output is written to <path>.csv and <path>.json, interval is in seconds, 0 disables periodic snapshots
+        MTelemetry(std::string path = "data/telemetry", double interval = 5);
+
+        MTelemetry(const MTelemetry &) = delete;
+
+        MTelemetry &operator=(const MTelemetry &) = delete;
+
+        void record(Stage stage, double seconds);
+
+        inline void setGauge(Gauge gauge, long value)
+        {
+            m_gauges[static_cast<size_t>(gauge)].store(value, std::memory_order_relaxed);
+        }
+
+        //for gauges counting events, several threads may add at once
+        inline void addGauge(Gauge gauge, long value)
+        {
+            m_gauges[static_cast<size_t>(gauge)].fetch_add(value, std::memory_order_relaxed);
+        }
+
+        inline long gauge(Gauge gauge) const
+        {
+            return m_gauges[static_cast<size_t>(gauge)].load(std::memory_order_relaxed);
+        }
+
+        //remembers the size of the geometry of an object after its last cut
+        void label(const void *object, long triangles, long nefVertices, long nefFacets);
+
+        void forget(const void *object);
+
+        Summary summary(Stage stage) const;
+
+        //writes a snapshot if the interval has elapsed since the last one, called every frame
+        void maybeSnapshot();
+
+        void snapshot();
+
+        void printSummary(std::ostream &os, double seconds) const;
+
+        static const char *name(Stage stage);
+
+        static const char *name(Gauge gauge);
+
+    private:
+        struct ThreadHistograms
+        {
+            std::array<MHistogram, static_cast<size_t>(Stage::COUNT)> stages;
+        };
+
+        struct Label
+        {
+            long triangles, nefVertices, nefFacets, cuts;
+        };
+
+        typedef std::chrono::steady_clock clock_;
+
+        ThreadHistograms &local();
+
+        void writeCsv(std::ostream &os, double time) const;
+
+        void writeJson(std::ostream &os, double time) const;
+
+        const unsigned m_id;
+        const std::string m_path;
+        const double m_interval;
+        clock_::time_point m_start, m_lastSnapshot;
+        bool m_csvHeader = false;
+
+        mutable std::mutex m_threadsMutex;
+        std::vector<std::unique_ptr<ThreadHistograms>> m_threads;
+
+        std::array<std::atomic<long>, static_cast<size_t>(Gauge::COUNT)> m_gauges;
+
+        mutable std::mutex m_labelsMutex;
+        std::map<const void *, Label> m_labels;
+    };
+
+}
+
+#endif // TELEMETRY_H
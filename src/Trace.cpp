@@ -0,0 +1,116 @@
+#include "Trace.h"
+#include <fstream>
+#include <iostream>
+
+std::atomic<bool> gg::MTrace::s_enabled {false};
+std::atomic<uint64_t> gg::MTrace::s_flows {0};
+std::string gg::MTrace::s_path;
+std::chrono::steady_clock::time_point gg::MTrace::s_start;
+std::mutex gg::MTrace::s_buffersMutex;
+std::vector<std::unique_ptr<gg::MTrace::ThreadBuffer>> gg::MTrace::s_buffers;
+
+void gg::MTrace::start(const std::string &path)
+{
+    std::lock_guard<std::mutex> lock(s_buffersMutex);
+    s_path = path;
+    s_start = std::chrono::steady_clock::now();
+    s_enabled.store(true);
+}
+
+void gg::MTrace::stop()
+{
+    if(!s_enabled.exchange(false))
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(s_buffersMutex);
+    std::ofstream out(s_path, std::ofstream::trunc);
+    if(!out.is_open())
+    {
+        std::cerr << "Trace " << s_path << " could not be written\n";
+        return;
+    }
+
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    out << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 0, \"args\": {\"name\": \"game\"}}";
+    out.precision(3);
+    out << std::fixed;
+    for(auto &&buffer : s_buffers)
+    {
+        if(!buffer->name.empty())
+        {
+            out << ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << buffer->tid
+                << ", \"args\": {\"name\": \"" << buffer->name << "\"}}";
+        }
+        for(auto &&e : buffer->events)
+        {
+            out << ",\n{\"name\": \"" << e.name << "\", \"ph\": \"" << e.phase << "\", \"pid\": 1, \"tid\": "
+                << buffer->tid << ", \"ts\": " << e.timestamp;
+            if(e.phase == 'X')
+            {
+                out << ", \"dur\": " << e.duration;
+            }
+            else
+            {
+                //flow events bind to the span that encloses them, the last one to the span it ends in
+                out << ", \"cat\": \"impact\", \"id\": " << e.flow;
+                if(e.phase == 'f')
+                {
+                    out << ", \"bp\": \"e\"";
+                }
+            }
+            out << "}";
+        }
+        buffer->events.clear();
+    }
+    out << "\n]}\n";
+}
+
+uint64_t gg::MTrace::newFlow()
+{
+    return enabled() ? ++s_flows : 0;
+}
+
+void gg::MTrace::nameThread(const char *name)
+{
+    if(enabled())
+    {
+        local().name = name;
+    }
+}
+
+gg::MTrace::ThreadBuffer &gg::MTrace::local()
+{
+    thread_local ThreadBuffer *buffer = nullptr;
+    if(!buffer)
+    {
+        std::lock_guard<std::mutex> lock(s_buffersMutex);
+        s_buffers.push_back(std::make_unique<ThreadBuffer>());
+        buffer = s_buffers.back().get();
+        buffer->tid = static_cast<int>(s_buffers.size());
+    }
+    return *buffer;
+}
+
+double gg::MTrace::now()
+{
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - s_start).count();
+}
+
+void gg::MTraceSpan::begin(const char *name, uint64_t flow, MTrace::Flow phase)
+{
+    m_name = name;
+    m_begin = MTrace::now();
+    if(flow != 0 && phase != MTrace::Flow::NONE)
+    {
+        const char phases[] = {' ', 's', 't', 'f'};
+        MTrace::local().events.push_back({"impact", phases[static_cast<int>(phase)], m_begin, 0, flow});
+    }
+}
+
+void gg::MTraceSpan::end()
+{
+    double end = MTrace::now();
+    MTrace::local().events.push_back({m_name, 'X', m_begin, end - m_begin, 0});
+}
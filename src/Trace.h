@@ -0,0 +1,110 @@
+/*
+ * records the destruction pipeline in the Chrome trace event format (chrome://tracing, Perfetto).
+ * Spans are complete ("X") events, one impact is followed across the threads by flow events
+ * that share its id. Every thread appends to its own buffer, the buffers are written out by stop().
+ * When tracing is not enabled a span is a single branch on a global flag and records nothing.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace gg
+{
+
+    class MTrace
+    {
+    public:
+        enum class Flow
+        {
+            NONE, START, STEP, END
+        };
+
+        //enables tracing, the trace is written to the file by stop()
+        static void start(const std::string &path);
+
+        static void stop();
+
+        static inline bool enabled()
+        {
+            return s_enabled.load(std::memory_order_relaxed);
+        }
+
+        //id that links the events of one impact, 0 when tracing is disabled
+        static uint64_t newFlow();
+
+        static void nameThread(const char *name);
+
+    private:
+        friend class MTraceSpan;
+
+        struct Event
+        {
+            const char *name;
+            char phase;
+            double timestamp, duration;
+            uint64_t flow;
+        };
+
+        struct ThreadBuffer
+        {
+            int tid;
+            std::string name;
+            std::vector<Event> events;
+        };
+
+        static ThreadBuffer &local();
+
+        static double now();
+
+        static std::atomic<bool> s_enabled;
+        static std::atomic<uint64_t> s_flows;
+        static std::string s_path;
+        static std::chrono::steady_clock::time_point s_start;
+        static std::mutex s_buffersMutex;
+        static std::vector<std::unique_ptr<ThreadBuffer>> s_buffers;
+    };
+
+    //traces the scope it lives in, optionally as one step of an impact's flow
+    class MTraceSpan
+    {
+    public:
+        inline MTraceSpan(const char *name, uint64_t flow = 0, MTrace::Flow phase = MTrace::Flow::NONE)
+        {
+            if(MTrace::enabled())
+            {
+                begin(name, flow, phase);
+            }
+        }
+
+        inline ~MTraceSpan()
+        {
+            if(m_name)
+            {
+                end();
+            }
+        }
+
+        MTraceSpan(const MTraceSpan &) = delete;
+
+        MTraceSpan &operator=(const MTraceSpan &) = delete;
+
+    private:
+        void begin(const char *name, uint64_t flow, MTrace::Flow phase);
+
+        void end();
+
+        const char *m_name = nullptr;
+        double m_begin = 0;
+    };
+
+}
+
+#endif // TRACE_H
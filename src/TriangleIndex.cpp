@@ -0,0 +1,192 @@
+#include "TriangleIndex.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    const long LIMIT = 1L << 40;
+
+    //triangles over more cells are kept aside and are near every box
+    const double LARGE = 64;
+
+    double cellsIn(const long *from, const long *to)
+    {
+        double cells = 1;
+        for(int k = 0; k < 3; k++)
+        {
+            cells *= static_cast<double>(to[k] - from[k] + 1);
+        }
+        return cells;
+    }
+
+    long cellOf(double coordinate, double cell)
+    {
+        double position = std::floor(coordinate / cell);
+        if(!(position > -LIMIT))
+        {
+            return -LIMIT;
+        }
+        return position < LIMIT ? static_cast<long>(position) : LIMIT;
+    }
+}
+
+gg::MTriangleIndex::MTriangleIndex(const MTriangleMesh &mesh)
+{
+    double extent = 0;
+    for(size_t t = 0; t < mesh.indices.size(); t += 3)
+    {
+        double low[3], high[3];
+        for(int k = 0; k < 3; k++)
+        {
+            low[k] = high[k] = mesh.vertices[mesh.indices[t] * 3 + k];
+            for(int j = 1; j < 3; j++)
+            {
+                low[k] = std::min(low[k], mesh.vertices[mesh.indices[t + j] * 3 + k]);
+                high[k] = std::max(high[k], mesh.vertices[mesh.indices[t + j] * 3 + k]);
+            }
+        }
+        extent += std::max({high[0] - low[0], high[1] - low[1], high[2] - low[2]});
+    }
+    if(extent > 0)
+    {
+        m_cell = 2 * extent / static_cast<double>(mesh.triangleCount());
+    }
+    if(!mesh.vertices.empty())
+    {
+        for(int k = 0; k < 3; k++)
+        {
+            m_low[k] = m_high[k] = mesh.vertices[k];
+        }
+    }
+    m_cells.reserve(mesh.triangleCount());
+    for(uint32_t t = 0; t < mesh.triangleCount(); t++)
+    {
+        insert(mesh, t);
+    }
+}
+
+void gg::MTriangleIndex::insert(const MTriangleMesh &mesh, uint32_t triangle)
+{
+    long from[3], to[3];
+    range(mesh, triangle, from, to);
+    if(cellsIn(from, to) > LARGE)
+    {
+        m_large.push_back(triangle);
+        return;
+    }
+    for(long x = from[0]; x <= to[0]; x++)
+    {
+        for(long y = from[1]; y <= to[1]; y++)
+        {
+            for(long z = from[2]; z <= to[2]; z++)
+            {
+                m_cells[key(x, y, z)].push_back(triangle);
+            }
+        }
+    }
+}
+
+void gg::MTriangleIndex::remove(const MTriangleMesh &mesh, uint32_t triangle)
+{
+    long from[3], to[3];
+    range(mesh, triangle, from, to);
+    if(cellsIn(from, to) > LARGE)
+    {
+        auto found = std::find(m_large.begin(), m_large.end(), triangle);
+        if(found != m_large.end())
+        {
+            *found = m_large.back();
+            m_large.pop_back();
+        }
+        return;
+    }
+    for(long x = from[0]; x <= to[0]; x++)
+    {
+        for(long y = from[1]; y <= to[1]; y++)
+        {
+            for(long z = from[2]; z <= to[2]; z++)
+            {
+                auto cell = m_cells.find(key(x, y, z));
+                if(cell == m_cells.end())
+                {
+                    continue;
+                }
+                auto found = std::find(cell->second.begin(), cell->second.end(), triangle);
+                if(found != cell->second.end())
+                {
+                    *found = cell->second.back();
+                    cell->second.pop_back();
+                }
+                if(cell->second.empty())
+                {
+                    m_cells.erase(cell);
+                }
+            }
+        }
+    }
+}
+
+void gg::MTriangleIndex::query(const double *low, const double *high, std::vector<uint32_t> &triangles) const
+{
+    triangles.assign(m_large.begin(), m_large.end());
+    long from[3], to[3];
+    range(low, high, from, to);
+    if(cellsIn(from, to) > static_cast<double>(m_cells.size()))
+    {
+        //the box covers more cells than are filled, all triangles are near it
+        for(auto &&cell : m_cells)
+        {
+            triangles.insert(triangles.end(), cell.second.begin(), cell.second.end());
+        }
+    }
+    else
+    {
+        for(long x = from[0]; x <= to[0]; x++)
+        {
+            for(long y = from[1]; y <= to[1]; y++)
+            {
+                for(long z = from[2]; z <= to[2]; z++)
+                {
+                    auto cell = m_cells.find(key(x, y, z));
+                    if(cell != m_cells.end())
+                    {
+                        triangles.insert(triangles.end(), cell->second.begin(), cell->second.end());
+                    }
+                }
+            }
+        }
+    }
+    std::sort(triangles.begin(), triangles.end());
+    triangles.erase(std::unique(triangles.begin(), triangles.end()), triangles.end());
+}
+
+void gg::MTriangleIndex::range(const MTriangleMesh &mesh, uint32_t triangle, long *from, long *to)
+{
+    double low[3], high[3];
+    const uint32_t *v = &mesh.indices[triangle * 3];
+    for(int k = 0; k < 3; k++)
+    {
+        low[k] = std::min({mesh.vertices[v[0] * 3 + k], mesh.vertices[v[1] * 3 + k], mesh.vertices[v[2] * 3 + k]});
+        high[k] = std::max({mesh.vertices[v[0] * 3 + k], mesh.vertices[v[1] * 3 + k], mesh.vertices[v[2] * 3 + k]});
+        m_low[k] = std::min(m_low[k], low[k]);
+        m_high[k] = std::max(m_high[k], high[k]);
+    }
+    range(low, high, from, to);
+}
+
+void gg::MTriangleIndex::range(const double *low, const double *high, long *from, long *to) const
+{
+    for(int k = 0; k < 3; k++)
+    {
+        from[k] = cellOf(low[k], m_cell);
+        to[k] = cellOf(high[k], m_cell);
+    }
+}
+
+uint64_t gg::MTriangleIndex::key(long x, long y, long z)
+{
+    const uint64_t mask = (1u << 21) - 1;
+    return (static_cast<uint64_t>(x) & mask) << 42 | (static_cast<uint64_t>(y) & mask) << 21
+           | (static_cast<uint64_t>(z) & mask);
+}
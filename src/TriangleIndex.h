@@ -0,0 +1,64 @@
+/*
+ * spatial index of the triangles of an MTriangleMesh, lets the fast booleans find the patch around a cutter
+ * without visiting the whole mesh. The bounding box of every triangle is entered into the cells of a uniform grid
+ * it overlaps, the cells live in a hash table, so only the cells near the surface take memory. The size of the cells
+ * is chosen from the triangles the index is built with, the few triangles far larger than a cell are kept in a list
+ * of their own that every query returns; a cut removes the triangles it replaces and inserts the new
+ * ones, so the index follows its mesh from cut to cut.
+ */
+
+#ifndef TRIANGLEINDEX_H
+#define TRIANGLEINDEX_H
+
+#include "TriangleMesh.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace gg
+{
+
+    class MTriangleIndex
+    {
+    public:
+        MTriangleIndex() = default;
+
+        //cells twice the mean extent of the triangles of the mesh
+        explicit MTriangleIndex(const MTriangleMesh &mesh);
+
+        //the triangle as it is in the mesh now
+        void insert(const MTriangleMesh &mesh, uint32_t triangle);
+
+        //has to be called before the corners of the triangle change
+        void remove(const MTriangleMesh &mesh, uint32_t triangle);
+
+        //triangles whose boxes may reach the box, in ascending order, each once
+        void query(const double *low, const double *high, std::vector<uint32_t> &triangles) const;
+
+        //box of every vertex indexed so far, it does not shrink when the triangles are removed
+        inline const double *low() const
+        { return m_low; }
+
+        inline const double *high() const
+        { return m_high; }
+
+    private:
+        //cells the box of the triangle overlaps, from and to inclusive
+        void range(const MTriangleMesh &mesh, uint32_t triangle, long *from, long *to);
+
+        void range(const double *low, const double *high, long *from, long *to) const;
+
+        //coordinates wrap around, cells far apart may share a key and only cost a few more candidates
+        static uint64_t key(long x, long y, long z);
+
+        double m_cell = 1;
+        double m_low[3] = {0, 0, 0}, m_high[3] = {0, 0, 0};
+        std::unordered_map<uint64_t, std::vector<uint32_t>> m_cells;
+        std::vector<uint32_t> m_large;
+    };
+
+}
+
+#endif // TRIANGLEINDEX_H
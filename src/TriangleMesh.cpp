@@ -0,0 +1,205 @@
+#include "TriangleMesh.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <unordered_map>
+
+namespace
+{
+    const double PI = 3.14159265358979323846;
+
+    uint32_t findRoot(std::vector<uint32_t> &parents, uint32_t i)
+    {
+        while(parents[i] != i)
+        {
+            parents[i] = parents[parents[i]];
+            i = parents[i];
+        }
+        return i;
+    }
+
+    //union-find over the corners of every triangle, each vertex is joined with its shell
+    std::vector<uint32_t> joinShells(const gg::MTriangleMesh &mesh)
+    {
+        std::vector<uint32_t> parents(mesh.vertexCount());
+        std::iota(parents.begin(), parents.end(), 0);
+        for(size_t t = 0; t < mesh.indices.size(); t += 3)
+        {
+            for(int j = 1; j < 3; j++)
+            {
+                uint32_t a = findRoot(parents, mesh.indices[t]), b = findRoot(parents, mesh.indices[t + j]);
+                if(a != b)
+                {
+                    parents[std::max(a, b)] = std::min(a, b);
+                }
+            }
+        }
+        return parents;
+    }
+}
+
+double gg::MTriangleMesh::volume() const
+{
+    double sum = 0;
+    for(size_t t = 0; t < indices.size(); t += 3)
+    {
+        const double *a = &vertices[indices[t] * 3];
+        const double *b = &vertices[indices[t + 1] * 3];
+        const double *c = &vertices[indices[t + 2] * 3];
+        sum += a[0] * (b[1] * c[2] - b[2] * c[1]) - a[1] * (b[0] * c[2] - b[2] * c[0]) + a[2] * (b[0] * c[1] - b[1] * c[0]);
+    }
+    return sum / 6;
+}
+
+bool gg::MTriangleMesh::isClosed() const
+{
+    std::unordered_map<uint64_t, int> edges;
+    edges.reserve(indices.size());
+    for(size_t t = 0; t < indices.size(); t += 3)
+    {
+        for(int j = 0; j < 3; j++)
+        {
+            uint64_t from = indices[t + j], to = indices[t + (j + 1) % 3];
+            if(from == to || ++edges[from << 32 | to] > 1)
+            {
+                return false;
+            }
+        }
+    }
+    for(auto &&edge : edges)
+    {
+        if(edges.count(edge.first >> 32 | edge.first << 32) == 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+double gg::MTriangleMesh::winding(const double *point) const
+{
+    //sum of the solid angles of the triangles seen from the point (van Oosterom and Strackee)
+    double sum = 0;
+    for(size_t t = 0; t < indices.size(); t += 3)
+    {
+        double v[3][3];
+        double length[3];
+        for(int j = 0; j < 3; j++)
+        {
+            for(int k = 0; k < 3; k++)
+            {
+                v[j][k] = vertices[indices[t + j] * 3 + k] - point[k];
+            }
+            length[j] = std::sqrt(v[j][0] * v[j][0] + v[j][1] * v[j][1] + v[j][2] * v[j][2]);
+        }
+        double triple = v[0][0] * (v[1][1] * v[2][2] - v[1][2] * v[2][1])
+                        - v[0][1] * (v[1][0] * v[2][2] - v[1][2] * v[2][0])
+                        + v[0][2] * (v[1][0] * v[2][1] - v[1][1] * v[2][0]);
+        auto dot = [&v](int a, int b) { return v[a][0] * v[b][0] + v[a][1] * v[b][1] + v[a][2] * v[b][2]; };
+        double denominator = length[0] * length[1] * length[2] + dot(0, 1) * length[2] + dot(0, 2) * length[1]
+                             + dot(1, 2) * length[0];
+        sum += 2 * std::atan2(triple, denominator);
+    }
+    return sum / (4 * PI);
+}
+
+size_t gg::MTriangleMesh::shellCount() const
+{
+    std::vector<uint32_t> parents(joinShells(*this));
+    std::vector<char> counted(vertexCount(), false);
+    size_t shells = 0;
+    for(size_t t = 0; t < indices.size(); t += 3)
+    {
+        uint32_t root = findRoot(parents, indices[t]);
+        if(!counted[root])
+        {
+            counted[root] = true;
+            shells++;
+        }
+    }
+    return shells;
+}
+
+std::vector<gg::MTriangleMesh> gg::MTriangleMesh::components() const
+{
+    std::vector<uint32_t> parents(joinShells(*this));
+
+    //dense numbering of the shells
+    std::vector<uint32_t> shellOf(vertexCount(), UINT32_MAX);
+    uint32_t shells = 0;
+    for(size_t t = 0; t < indices.size(); t += 3)
+    {
+        uint32_t root = findRoot(parents, indices[t]);
+        if(shellOf[root] == UINT32_MAX)
+        {
+            shellOf[root] = shells++;
+        }
+    }
+
+    std::vector<MTriangleMesh> parts(shells);
+    std::vector<uint32_t> remap(vertexCount(), UINT32_MAX);
+    for(size_t t = 0; t < indices.size(); t += 3)
+    {
+        MTriangleMesh &part = parts[shellOf[findRoot(parents, indices[t])]];
+        for(int j = 0; j < 3; j++)
+        {
+            uint32_t i = indices[t + j];
+            if(remap[i] == UINT32_MAX)
+            {
+                remap[i] = static_cast<uint32_t>(part.vertexCount());
+                part.vertices.insert(part.vertices.end(), &vertices[i * 3], &vertices[i * 3 + 3]);
+            }
+            part.indices.push_back(remap[i]);
+        }
+    }
+    if(parts.size() < 2)
+    {
+        return parts;
+    }
+
+    //cavities are moved into the smallest solid that contains them
+    std::vector<double> volumes;
+    for(auto &&part : parts)
+    {
+        volumes.push_back(part.volume());
+    }
+    std::vector<MTriangleMesh> solids;
+    std::vector<size_t> solidOf(parts.size(), SIZE_MAX);
+    for(size_t i = 0; i < parts.size(); i++)
+    {
+        if(volumes[i] > 0)
+        {
+            solidOf[i] = solids.size();
+            solids.push_back(parts[i]);
+        }
+    }
+    for(size_t i = 0; i < parts.size(); i++)
+    {
+        if(volumes[i] > 0)
+        {
+            continue;
+        }
+        size_t best = SIZE_MAX;
+        for(size_t j = 0; j < parts.size(); j++)
+        {
+            if(volumes[j] > 0 && (best == SIZE_MAX || volumes[j] < volumes[best]) && parts[j].contains(&parts[i].vertices[0]))
+            {
+                best = j;
+            }
+        }
+        if(best == SIZE_MAX)
+        {
+            //an inverted shell on its own is not a solid
+            continue;
+        }
+        MTriangleMesh &solid = solids[solidOf[best]];
+        uint32_t offset = static_cast<uint32_t>(solid.vertexCount());
+        solid.vertices.insert(solid.vertices.end(), parts[i].vertices.begin(), parts[i].vertices.end());
+        for(auto &&index : parts[i].indices)
+        {
+            solid.indices.push_back(index + offset);
+        }
+    }
+    return solids;
+}
@@ -0,0 +1,55 @@
+/*
+ * plain indexed triangle mesh used by the fast geometry paths.
+ * Vertices are stored as consecutive x, y, z doubles, triangles as consecutive vertex indices,
+ * counter-clockwise when seen from outside. Meshes coming from the booleans are welded:
+ * a vertex shared by several triangles is stored once, so the topology can be read from the indices.
+ * The fast booleans cut a mesh in place and leave the vertices of the triangles they replace behind,
+ * so a mesh may hold vertices that no triangle uses.
+ */
+
+#ifndef TRIANGLEMESH_H
+#define TRIANGLEMESH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace gg
+{
+
+    struct MTriangleMesh
+    {
+        std::vector<double> vertices;
+        std::vector<uint32_t> indices;
+
+        inline size_t vertexCount() const
+        { return vertices.size() / 3; }
+
+        inline size_t triangleCount() const
+        { return indices.size() / 3; }
+
+        inline bool empty() const
+        { return indices.empty(); }
+
+        //signed volume, positive for a closed mesh oriented outwards
+        double volume() const;
+
+        //every edge is used exactly once in each direction
+        bool isClosed() const;
+
+        //generalized winding number of the point, 1 inside and 0 outside a closed mesh
+        double winding(const double *point) const;
+
+        inline bool contains(const double *point) const
+        { return winding(point) > 0.5; }
+
+        //connected sets of triangles
+        size_t shellCount() const;
+
+        //separate solids, a closed shell oriented inwards is kept with the solid it is a cavity of
+        std::vector<MTriangleMesh> components() const;
+    };
+
+}
+
+#endif // TRIANGLEMESH_H
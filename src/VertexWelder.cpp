@@ -0,0 +1,64 @@
+#include "VertexWelder.h"
+
+#include <cmath>
+#include <cstring>
+
+constexpr uint32_t gg::MVertexWelder::EMPTY;
+
+//bits of the coordinate, with both zeros mapped to the same key
+static uint64_t coordinateBits(double value)
+{
+    uint64_t bits = 0;
+    if(value != 0)
+    {
+        std::memcpy(&bits, &value, sizeof(bits));
+    }
+    return bits;
+}
+
+static uint64_t mix(uint64_t hash, uint64_t value)
+{
+    hash ^= value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    return hash ^ (hash >> 33);
+}
+
+gg::MVertexWelder::MVertexWelder(MTriangleMesh &mesh, size_t corners, double epsilon)
+        : m_mesh(mesh), m_epsilon(epsilon)
+{
+    //at most half full, so that a probe ends after a few slots
+    size_t size = 16;
+    while(size < 2 * corners)
+    {
+        size *= 2;
+    }
+    m_slots.assign(size, EMPTY);
+    m_mask = size - 1;
+}
+
+uint32_t gg::MVertexWelder::add(double x, double y, double z)
+{
+    if(m_epsilon > 0)
+    {
+        x = std::round(x / m_epsilon) * m_epsilon;
+        y = std::round(y / m_epsilon) * m_epsilon;
+        z = std::round(z / m_epsilon) * m_epsilon;
+    }
+    size_t slot = mix(mix(mix(0, coordinateBits(x)), coordinateBits(y)), coordinateBits(z)) & m_mask;
+    while(m_slots[slot] != EMPTY)
+    {
+        const double *vertex = &m_mesh.vertices[3 * static_cast<size_t>(m_slots[slot])];
+        if(vertex[0] == x && vertex[1] == y && vertex[2] == z)
+        {
+            return m_slots[slot];
+        }
+        slot = (slot + 1) & m_mask;
+    }
+    uint32_t index = static_cast<uint32_t>(m_mesh.vertexCount());
+    m_slots[slot] = index;
+    m_mesh.vertices.push_back(x);
+    m_mesh.vertices.push_back(y);
+    m_mesh.vertices.push_back(z);
+    return index;
+}
@@ -0,0 +1,40 @@
+/*
+ * merges the corners of a triangle soup into shared vertices of an indexed mesh.
+ * Positions are looked up in a flat open-addressing table, sized once from the number of corners,
+ * so a mesh is welded in linear time without allocating per vertex. With a positive epsilon the
+ * positions are first snapped to a grid of that spacing, which also merges nearly coincident vertices.
+ */
+
+#ifndef VERTEXWELDER_H
+#define VERTEXWELDER_H
+
+#include "TriangleMesh.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace gg
+{
+
+    class MVertexWelder
+    {
+    public:
+        //the table is sized for corners positions, the new vertices are appended to mesh
+        MVertexWelder(MTriangleMesh &mesh, size_t corners, double epsilon = 0);
+
+        //index of the vertex at the position, new positions are added to the mesh
+        uint32_t add(double x, double y, double z);
+
+    private:
+        static constexpr uint32_t EMPTY = UINT32_MAX;
+
+        MTriangleMesh &m_mesh;
+        const double m_epsilon;
+        std::vector<uint32_t> m_slots; //vertex indices, the size is a power of two
+        size_t m_mask;
+    };
+
+}
+
+#endif // VERTEXWELDER_H
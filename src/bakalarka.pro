@@ -5,20 +5,43 @@ CONFIG -= qt
 
 SOURCES += main.cpp \
     CollisionResolver.cpp \
+    CutterLibrary.cpp \
     EventReceiver.cpp \
+    FastBoolean.cpp \
     Game.cpp \
+    Geometry.cpp \
     Loader.cpp \
     ObjectCreator.cpp \
-    MeshManipulators.cpp
+    MeshManipulators.cpp \
+    Prefracture.cpp \
+    Script.cpp \
+    Telemetry.cpp \
+    Trace.cpp \
+    TriangleIndex.cpp \
+    TriangleMesh.cpp \
+    VertexWelder.cpp
 
 HEADERS += \
+    Channel.h \
     CollisionResolver.h \
+    CutterLibrary.h \
     EventReceiver.h \
+    FastBoolean.h \
     Game.h \
+    Geometry.h \
     Loader.h \
     Object.h \
     ObjectCreator.h \
-    MeshManipulators.h
+    MeshManipulators.h \
+    Prefracture.h \
+    Script.h \
+    Settings.h \
+    Stage.h \
+    Telemetry.h \
+    Trace.h \
+    TriangleIndex.h \
+    TriangleMesh.h \
+    VertexWelder.h
 INCLUDEPATH += \
     /usr/include/bullet \
     /usr/include/irrlicht \
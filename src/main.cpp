@@ -1,17 +1,95 @@
 #include <string>
+#include <iostream>
+#include <map>
+#include <stdexcept>
 
 #include "Game.h"
 
 int main(int argc, char **argv)
 {
-    bool debug = 0;
-    if(argc > 1)
+    gg::MSettings settings;
+    const std::map<std::string, gg::MSettings::Boolean> booleans = {{"nef",      gg::MSettings::Boolean::NEF},
+                                                                    {"fast",     gg::MSettings::Boolean::FAST},
+                                                                    {"corefine", gg::MSettings::Boolean::COREFINEMENT}};
+    const std::string usage = std::string("usage: ") + argv[0] + " [-d] [-t trace.json] [-j workers] [-k workers] [-b ms]"
+                              " [-q soft hard] [-g nef|fast|corefine] [-v cells] [-r seed] [-s script]\n";
+    //std::stoul and std::stod throw on values that are not numbers or do not fit
+    try
     {
-        debug = std::string(argv[1]) == "-d";
+        for(int i = 1; i < argc; i++)
+        {
+            std::string argument(argv[i]);
+            if(argument == "-d")
+            {
+                settings.debug = true;
+            }
+            else if(argument == "-t" && i + 1 < argc)
+            {
+                settings.trace = argv[++i];
+            }
+            else if(argument == "-j" && i + 1 < argc)
+            {
+                settings.subtractionWorkers = std::stoul(argv[++i]);
+            }
+            else if(argument == "-k" && i + 1 < argc)
+            {
+                settings.decompositionWorkers = std::stoul(argv[++i]);
+            }
+            else if(argument == "-b" && i + 1 < argc)
+            {
+                settings.applyBudget = std::stod(argv[++i]);
+            }
+            else if(argument == "-q" && i + 2 < argc)
+            {
+                settings.softLimit = std::stoul(argv[++i]);
+                settings.hardLimit = std::stoul(argv[++i]);
+            }
+            else if(argument == "-g" && i + 1 < argc && booleans.count(argv[i + 1]))
+            {
+                settings.boolean = booleans.at(argv[++i]);
+            }
+            else if(argument == "-v" && i + 1 < argc)
+            {
+                settings.shatterCells = std::stoul(argv[++i]);
+            }
+            else if(argument == "-r" && i + 1 < argc)
+            {
+                settings.seed = std::stoul(argv[++i]);
+            }
+            else if(argument == "-s" && i + 1 < argc)
+            {
+                settings.headless = true;
+                settings.script = argv[++i];
+            }
+            else
+            {
+                std::cerr << usage;
+                return 1;
+            }
+        }
     }
-    gg::MGame g;
-    g.run(debug);
-
+    catch(std::logic_error &)
+    {
+        std::cerr << usage;
+        return 1;
+    }
+#if !GG_COREFINEMENT
+    if(settings.boolean == gg::MSettings::Boolean::COREFINEMENT)
+    {
+        std::cerr << "corefinement needs CGAL 5.1, the cuts are computed on Nef polyhedra\n";
+        settings.boolean = gg::MSettings::Boolean::NEF;
+    }
+#endif
+    if(!settings.trace.empty())
+    {
+        gg::MTrace::start(settings.trace);
+    }
+    {
+        gg::MGame g(settings);
+        g.run();
+    }
+    //the worker threads are joined by now, so all spans are complete
+    gg::MTrace::stop();
 
     return 0;
 }